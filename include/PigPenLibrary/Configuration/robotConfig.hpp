@@ -13,4 +13,12 @@ extern const double WHEEL_DIAMETER;
 extern const double LEFT_OFFSET;
 extern const double RIGHT_OFFSET;
 extern const double REAR_OFFSET;
-/*******************************************************************/
\ No newline at end of file
+/*******************************************************************/
+
+/********************************************************************
+ * @brief Drivetrain Robot Config Declarations
+ */
+extern const double DRIVE_WHEEL_DIAMETER;
+extern const double DRIVE_GEAR_RATIO;
+extern const double DRIVE_TRACK_WIDTH;
+/*******************************************************************/
@@ -9,20 +9,41 @@ private:
     double kI;
     double kD;
     int minSpeed;
-    double accelStep;
-    int error;
+    double maxOutput;
+    double error;
+
+    //State kept between calls to getOutput() (cleared by reset())
+    double integral;
+    double derivative;
+    double prevMeasurement;
+    std::uint64_t prevTime;
+    bool firstStep;
+
+    double integralZone;
+    double maxIntegral;
+    double derivativeFilter;
+    double errorBand;
+    double errorScale;
+    ResponseMetrics *metrics;
 
     double DEFAULT_KP;
     double DEFAULT_KI;
     double DEFAULT_KD;
     double DEFAULT_MINSPEED;
 
+    double calculate(double error, double measurement);
+
 public:
-    PIDController(double kP, double kI, double kD, int inMinSpeed);
+    PIDController(double kP, double kI, double kD, int inMinSpeed, double maxOutput = 127);
     PIDController(double kP, int inMinSpeed);
-    int getOutput(int target, int current);
-    int getOutput(int error);
+    double getOutput(double target, double current);
+    double getOutput(double error);
+    void reset();
     void setGains(double kP, double kI, double kD, int minSpeed);
+    void setIntegralLimits(double integralZone, double maxIntegral);
+    void setDerivativeFilter(double derivativeFilter);
+    void setErrorScaling(double errorBand, double errorScale);
+    void recordMetrics(ResponseMetrics *metrics);
     void resetGainsToDefaults();
     bool gainsAreAtDefaults();
     double getError();
@@ -0,0 +1,56 @@
+#define TUNE_TURN 0
+#define TUNE_MOVE 1
+
+#define TUNING_RULE_ZIEGLER_NICHOLS 0
+#define TUNING_RULE_TYREUS_LUYBEN 1
+#define TUNING_RULE_NO_OVERSHOOT 2
+
+/**
+ * @brief Result of a relay test
+ * 
+ * ultimateGain (Ku) is in power per degree or inch and ultimatePeriod (Tu)
+ * is in seconds. success is false if the chassis never settled into a
+ * steady oscillation before the timeout.
+ */
+struct RelayResult
+{
+    double ultimateGain;
+    double ultimatePeriod;
+    bool success;
+};
+
+/**
+ * @brief Relay Auto Tuner Class Declaration
+ * 
+ * Runs an Astrom-Hagglund relay test: the chassis is driven at +-relayPower
+ * depending on which side of its starting heading (or position) it is on,
+ * which makes it oscillate. The amplitude and period of that oscillation
+ * give the ultimate gain and period, from which tuneGains() proposes PID
+ * gains. 
+ * 
+ * EXAMPLE (in autonomous, with room to rock back and forth):
+ * RelayAutoTuner tuner(40, 1);
+ * RelayResult result = tuner.run(TUNE_TURN);
+ * RelayAutoTuner::printProposals(result, 15);
+ * RelayAutoTuner::saveGains(RelayAutoTuner::tuneGains(result, TUNING_RULE_TYREUS_LUYBEN, 15), TUNE_TURN);
+ */
+class RelayAutoTuner
+{
+private:
+    double relayPower;
+    double hysteresis;
+    int cycles;
+    int timeout;
+
+public:
+    RelayAutoTuner(double relayPower, double hysteresis, int cycles = 6, int timeout = 15000);
+    RelayResult run(int tuneType);
+
+    static GainPoint tuneGains(RelayResult result, int rule, int minSpeed);
+    static void printProposals(RelayResult result, int minSpeed);
+    static bool saveGains(GainPoint gains, int tuneType);
+    static bool saveProfile(GainPoint gains, int id, const char *name);
+    static void loadSavedGains();
+};
+
+extern const char *TUNED_GAINS_FILE;
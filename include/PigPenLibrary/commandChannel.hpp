@@ -0,0 +1,59 @@
+/**
+ * @brief Command Channel Class Declaration
+ * 
+ * Fixed-capacity ring that passes items by value from one producer task to
+ * one consumer task without a mutex. The producer only writes tail and the
+ * consumer only writes head, so neither ever waits on the other; push()
+ * returns false when the ring is full and pop() returns false when it is
+ * empty.
+ * 
+ * Only one task may push and only one task may pop.
+ * 
+ * EXAMPLE:
+ * CommandChannel<MotionCommand, 4> channel;
+ * channel.push(command); //caller
+ * channel.pop(command);  //drive task
+ */
+template <typename T, unsigned int Capacity>
+class CommandChannel
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+private:
+    T slots[Capacity];
+    std::atomic<std::uint32_t> head{0}; //next slot to pop, written by the consumer
+    std::atomic<std::uint32_t> tail{0}; //next slot to push, written by the producer
+
+public:
+    //Producer: copy item into the ring
+    bool push(const T &item)
+    {
+        std::uint32_t index = tail.load(std::memory_order_relaxed);
+        if (index - head.load(std::memory_order_acquire) == Capacity)
+        {
+            return false;
+        }
+        slots[index & (Capacity - 1)] = item;
+        tail.store(index + 1, std::memory_order_release);
+        return true;
+    }
+
+    //Consumer: copy the oldest item out of the ring
+    bool pop(T &item)
+    {
+        std::uint32_t index = head.load(std::memory_order_relaxed);
+        if (index == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        item = slots[index & (Capacity - 1)];
+        head.store(index + 1, std::memory_order_release);
+        return true;
+    }
+
+    //Either side: is there nothing waiting to be popped
+    bool empty() const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
@@ -0,0 +1,224 @@
+/**
+ * @brief Composed Controller Declarations
+ *
+ * A ComposedController is built from terms chosen at compile time, so a
+ * P-only loop is just a multiply: the I/D state, timing and minSpeed logic
+ * of PIDController only exist when those terms are listed.
+ *
+ * Terms run in the order they are listed, each taking the output so far
+ * and returning the new output. Put the additive terms (P, I, D, FF) first
+ * and the shaping terms (MinOutput, Deadband) last.
+ *
+ * EXAMPLE:
+ * ComposedController<terms::P> headingPID(terms::P(4));
+ * ComposedController<terms::P, terms::D, terms::MinOutput> pid(terms::P(1.25), terms::D(0.1), terms::MinOutput(15));
+ *
+ * Every controller has getOutput(target, current), getOutput(error) and
+ * reset(), so it can be used anywhere a PIDController is.
+ */
+
+/**
+ * @brief Values passed to each term for one controller step
+ *
+ */
+struct ControlStep
+{
+    double target;
+    double measurement;
+    double error;
+    double dt; //seconds since the last step (0 on the first step or if no term needs time)
+};
+
+namespace terms
+{
+    //Base for terms that keep no state between steps
+    struct Stateless
+    {
+        static constexpr bool needsTime = false;
+        void reset() {}
+    };
+
+    //Proportional: kP * error
+    struct P : Stateless
+    {
+        double kP;
+        explicit P(double inKP) : kP(inKP) {}
+        double apply(double output, const ControlStep &step) const { return output + kP * step.error; }
+    };
+
+    /**
+     * @brief Integral: kI * accumulated error
+     *
+     * Only builds while |error| < zone (0 = always), drops when the error
+     * changes sign and never contributes more than +-maxOutput.
+     */
+    struct I
+    {
+        static constexpr bool needsTime = true;
+        double kI;
+        double zone;
+        double maxOutput;
+        double integral = 0;
+
+        explicit I(double inKI, double inZone = 0, double inMaxOutput = 127) : kI(inKI), zone(inZone), maxOutput(inMaxOutput) {}
+        void reset() { integral = 0; }
+
+        double apply(double output, const ControlStep &step)
+        {
+            if ((zone > 0 && fabs(step.error) > zone) || step.error * integral < 0)
+            {
+                integral = 0;
+            }
+            else
+            {
+                integral += step.error * step.dt;
+            }
+            if (kI != 0)
+            {
+                double limit = maxOutput / fabs(kI);
+                integral = fmax(-limit, fmin(limit, integral));
+            }
+            return output + kI * integral;
+        }
+    };
+
+    /**
+     * @brief Derivative on measurement with a low-pass filter
+     *
+     * filter is the weight of each new sample (1 = unfiltered).
+     */
+    struct D
+    {
+        static constexpr bool needsTime = true;
+        double kD;
+        double filter;
+        double derivative = 0;
+        double prevMeasurement = 0;
+        bool firstStep = true;
+
+        explicit D(double inKD, double inFilter = 0.5) : kD(inKD), filter(inFilter) {}
+        void reset()
+        {
+            derivative = 0;
+            firstStep = true;
+        }
+
+        double apply(double output, const ControlStep &step)
+        {
+            if (!firstStep && step.dt > 0)
+            {
+                double rawDerivative = -(step.measurement - prevMeasurement) / step.dt;
+                derivative = filter * rawDerivative + (1 - filter) * derivative;
+            }
+            firstStep = false;
+            prevMeasurement = step.measurement;
+            return output + kD * derivative;
+        }
+    };
+
+    //Feedforward: kF * target (plus kS in the direction of the target)
+    struct FF : Stateless
+    {
+        double kF;
+        double kS;
+        explicit FF(double inKF, double inKS = 0) : kF(inKF), kS(inKS) {}
+        double apply(double output, const ControlStep &step) const
+        {
+            double staticOutput = step.target > 0 ? kS : (step.target < 0 ? -kS : 0);
+            return output + kF * step.target + staticOutput;
+        }
+    };
+
+    //Raise the output to at least +-minimum until |error| < tolerance (PIDController's minSpeed)
+    struct MinOutput : Stateless
+    {
+        double minimum;
+        double tolerance;
+        explicit MinOutput(double inMinimum, double inTolerance = 0.5) : minimum(inMinimum), tolerance(inTolerance) {}
+        double apply(double output, const ControlStep &step) const
+        {
+            if (fabs(step.error) >= tolerance && fabs(output) < minimum)
+            {
+                return step.error > 0 ? minimum : -minimum;
+            }
+            return output;
+        }
+    };
+
+    //Output 0 while |error| < band
+    struct Deadband : Stateless
+    {
+        double band;
+        explicit Deadband(double inBand) : band(inBand) {}
+        double apply(double output, const ControlStep &step) const { return fabs(step.error) < band ? 0 : output; }
+    };
+} // namespace terms
+
+//Time of the previous step, only stored when a term needs it
+template <bool NeedsTime>
+struct StepTimer
+{
+    double getDt() { return 0; }
+    void reset() {}
+};
+
+template <>
+struct StepTimer<true>
+{
+    std::uint64_t prevTime = 0;
+
+    double getDt()
+    {
+        std::uint64_t now = pros::micros();
+        double dt = prevTime == 0 ? 0 : (now - prevTime) / 1000000.0;
+        prevTime = now;
+        return dt;
+    }
+    void reset() { prevTime = 0; }
+};
+
+/**
+ * @brief Controller made of the listed terms
+ *
+ * Stateless terms hold only their gains, and pros::micros() is only read
+ * when a listed term needs the time step.
+ */
+template <typename... Terms>
+class ComposedController : private StepTimer<(false || ... || Terms::needsTime)>, private Terms...
+{
+private:
+    using Clock = StepTimer<(false || ... || Terms::needsTime)>;
+
+    double step(double target, double measurement, double error)
+    {
+        ControlStep controlStep{target, measurement, error, Clock::getDt()};
+
+        double output = 0;
+        ((output = static_cast<Terms &>(*this).apply(output, controlStep)), ...);
+        return output;
+    }
+
+public:
+    explicit ComposedController(Terms... inTerms) : Terms(inTerms)... {}
+
+    double getOutput(double target, double current) { return step(target, current, target - current); }
+
+    //With a fixed target the measurement changes opposite to the error
+    double getOutput(double error) { return step(error, -error, error); }
+
+    void reset()
+    {
+        Clock::reset();
+        (static_cast<Terms &>(*this).reset(), ...);
+    }
+
+    //Access a term to change its gains, ex. pid.term<terms::P>().kP = 2;
+    template <typename Term>
+    Term &term() { return static_cast<Term &>(*this); }
+};
+
+//Unused terms cost nothing: a composed controller is exactly the size of its terms' gains and state
+static_assert(sizeof(ComposedController<terms::P>) == sizeof(double), "P-only is a single gain");
+static_assert(sizeof(ComposedController<terms::P, terms::MinOutput>) == 3 * sizeof(double), "no timer without I/D");
+static_assert(sizeof(ComposedController<terms::P, terms::Deadband>) == 2 * sizeof(double), "no timer without I/D");
+static_assert(sizeof(ComposedController<terms::P, terms::D>) == sizeof(terms::P) + sizeof(terms::D) + sizeof(std::uint64_t), "D adds only its state and the timer");
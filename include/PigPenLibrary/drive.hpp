@@ -20,6 +20,35 @@ extern pros::Motor backLeft;
 #define MOVE_BACK_TO_Y_COORD 4
 #define MOVE_WITH_VISION_TO_X_COORD 6
 #define MOVE_WITH_VISION_TO_Y_COORD 7
+#define MOVE_TO_POSE 8
+#define MOVE_TO_POINT 9
+
+#define MOTION_COMPLETE 0
+#define MOTION_TIMEOUT 1
+#define MOTION_STALLED 2
+#define MOTION_CANCELLED 3
+
+#define MARKER_DISTANCE_TRAVELED 0
+#define MARKER_DISTANCE_REMAINING 1
+#define MARKER_TIME_ELAPSED 2
+#define MARKER_IN_REGION 3
+#define MARKER_HEADING 4
+
+#define MAX_MARKERS 8
+
+/* Tasks that can wait on movements at the same time without polling */
+#define MAX_WAITERS 4
+
+/* Commands that can be queued for the drive task (power of 2) */
+#define MOTION_QUEUE_SIZE 4
+
+#define COMMAND_MOVE 0
+#define COMMAND_TURN 1
+#define COMMAND_TRAJECTORY 2
+#define COMMAND_SEGMENTS 3
+
+/* Control loop period (ms) for every movement */
+#define MOTION_PERIOD 5
 
 #define TURN 0
 #define SWEEP_RIGHT 1
@@ -43,6 +72,8 @@ struct MoveTargets
     bool fluid;
     int moveType;
     int color = 2;
+    int targetX = 0;
+    int targetY = 0;
 };
 
 /**
@@ -58,8 +89,75 @@ struct TurnTargets
     int turnType;
 };
 
-extern MoveTargets moveTargets;
-extern TurnTargets turnTargets;
+/**
+ * @brief Event marker structure (see withMarker())
+ * 
+ * a-d hold the marker's values (a region uses all four corners, and a
+ * heading marker uses c to remember which side of a it started on)
+ */
+struct MotionMarker
+{
+    int type;
+    double a;
+    double b;
+    double c;
+    double d;
+    void (*callback)();
+    bool fired;
+};
+
+/**
+ * @brief Identifies one movement command so it can be waited on
+ * 
+ */
+struct MotionHandle
+{
+    std::uint32_t sequence;
+};
+
+/**
+ * @brief Gains for one movement (see withGains())
+ * 
+ */
+struct GainOverride
+{
+    bool enabled = false;
+    double kP;
+    double kI;
+    double kD;
+    int minSpeed;
+};
+
+/**
+ * @brief One movement and every modifier set for it, passed to the drive task by value
+ * 
+ * The with*() modifiers fill in the next command; starting a movement
+ * sends it to the drive task and starts a fresh one. Trajectory commands
+ * only carry a pointer, so the points must outlive the movement.
+ */
+struct MotionCommand
+{
+    std::uint32_t sequence = 0;
+    std::uint8_t status = 0; //competition status when it was sent
+    int type = COMMAND_MOVE;
+    MoveTargets move = {};
+    TurnTargets turn = {};
+    const TrajectoryPoint *points = nullptr;
+    const Segment *segments = nullptr;
+    int length = 0;
+    int dt = 0;
+
+    GainOverride moveGains;
+    GainOverride turnGains;
+    double correctionMultiplier = 1;
+    int exitSpeed = 0;
+    int timeout = 0;
+    SettleDetector *settle = nullptr;
+    int cascade = -1; //-1 = CASCADED_CONTROL
+    int mpc = -1;     //-1 = USE_MPC_TURNS
+    MotionMarker markers[MAX_MARKERS];
+    int markerCount = 0;
+};
 
 /**
  * @brief Drive Class Header
@@ -76,6 +174,10 @@ public:
     static void slewRightBack(int speed, int accelStep);
     static void slewLeftBack(int speed, int accelStep);
     static void drivePower(int l, int r);
+    static void matchSlewToVelocity();
+    static double applyExitSpeed(double speed);
+    static void driveVoltage(int l, int r);
+    static void driveVelocity(double l, double r, double lAccel = 0, double rAccel = 0);
     static void timedDrive(int time, int l, int r);
     static void brake();
     static void brakeRightSide();
@@ -83,17 +185,41 @@ public:
     static void coast();
     static void driveOP();
 
-    static void moveStartTask();
-    static void moveStopTask();
-
-    static void turnStartTask();
-    static void turnStopTask();
+    static void signalComplete(std::uint32_t sequence);
+    static void releaseWaiters();
+    static bool stopMotions();
+    static void cancel();
+    static void sendCommand(bool async);
+    static void startMove(MoveTargets targets, bool async);
+    static void startTurn(TurnTargets targets, bool async);
+    static void driveStartTask();
+    static void driveTask(void *parameter);
+    static void recordControlStep(std::uint32_t start, std::uint32_t release, int period);
+    static void runCommand();
 
     Drive &withCorrection(double cM);
+    Drive &withExitSpeed(int speed);
+    Drive &withSettle(SettleDetector &settle);
+    Drive &withTimeout(int timeout);
+    Drive &withCascade(bool enabled = true);
+    Drive &withMPC(bool enabled = true);
+    Drive &withMarker(int type, double value, void (*callback)());
+    Drive &withRegionMarker(double x1, double y1, double x2, double y2, void (*callback)());
+
+    static SettleDetector &startMotion(SettleDetector &defaultSettle);
+    static bool controlStep(double remaining);
+    static void dispatchMarkers(double remaining);
+    static void finishMotion(ResponseMetrics *response = nullptr);
+    static int getSettleTime();
+    static int getExitReason();
     Drive &withGains(double kP, double kI, double kD, int minSpeed);
     Drive &withTurnGains(double kP, double kI, double kD, int minSpeed);
+    Drive &withGainProfile(int id);
+    Drive &withTurnGainProfile(int id);
+    static void setTunedMoveGains(GainPoint gains);
+    static void setTunedTurnGains(GainPoint gains);
 
-    static void moveHeadingCorrection(int heading, double correctionMultiplier, double PIDSpeed, int accelStep, bool backward);
+    static void moveHeadingCorrection(double heading, double correctionMultiplier, double PIDSpeed);
 
     Drive &move(int distance, int heading, int accelStep, bool async = false, bool fluid = false);
 
@@ -102,19 +228,31 @@ public:
     Drive &moveBackToYCoord(int distance, int heading, int accelStep, bool async = false, bool fluid = false);
     Drive &moveBackToXCoord(int distance, int heading, int accelStep, bool async = false, bool fluid = false);
 
-    Drive &turn(int degrees);
-    Drive &sweepRight(int degrees, int rightSideSpeed);
-    Drive &sweepRight(int degrees, int rightSideSpeed, int errorThreshhold);
-    Drive &sweepLeft(int degrees, int leftSideSpeed);
-    Drive &sweepLeft(int degrees, int leftSideSpeed, int errorThreshhold);
-    Drive &sweepRightBack(int degrees, int leftSideSpeed);
-    Drive &sweepRightBack(int degrees, int rightSideSpeed, int errorThreshhold);
-    Drive &sweepLeftBack(int degrees, int rightSideSpeed);
-    Drive &sweepLeftBack(int degrees, int leftSideSpeed, int errorThreshhold);
+    Drive &moveToPoint(int x, int y, bool backward = false, bool async = false, bool fluid = false);
+    Drive &moveToPose(int x, int y, int theta, bool async = false, bool fluid = false);
+
+    Drive &followTrajectory(const TrajectoryPoint *points, int length, int dt = 10);
+    Drive &followTrajectory(const Segment *segments, int length);
+
+    Drive &turn(int degrees, bool async = false);
+    Drive &sweepRight(int degrees, int rightSideSpeed, bool async = false);
+    Drive &sweepRight(int degrees, int rightSideSpeed, int errorThreshhold, bool async = false);
+    Drive &sweepLeft(int degrees, int leftSideSpeed, bool async = false);
+    Drive &sweepLeft(int degrees, int leftSideSpeed, int errorThreshhold, bool async = false);
+    Drive &sweepRightBack(int degrees, int leftSideSpeed, bool async = false);
+    Drive &sweepRightBack(int degrees, int rightSideSpeed, int errorThreshhold, bool async = false);
+    Drive &sweepLeftBack(int degrees, int rightSideSpeed, bool async = false);
+    Drive &sweepLeftBack(int degrees, int leftSideSpeed, int errorThreshhold, bool async = false);
 
     static void moveTask(void *parameter);
     static void turnTask(void *parameter);
-    void waitForComplete();
+    static void trajectoryTask(const TrajectoryPoint *points, int length, int dt);
+    static void trajectoryTask(const Segment *segments, int length, int dt);
+    MotionHandle getLastMotion();
+    bool isComplete(MotionHandle motion);
+    bool waitFor(MotionHandle motion, int timeout = -1);
+    bool waitForAll(const MotionHandle *motions, int count, int timeout = -1);
+    bool waitForComplete(int timeout = -1);
 };
 
 extern Drive drive;
\ No newline at end of file
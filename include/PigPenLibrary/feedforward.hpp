@@ -0,0 +1,18 @@
+/**
+ * @brief Drivetrain Feedforward Class Declaration
+ * 
+ * Models the voltage needed to hold a wheel velocity (inches per second)
+ * and acceleration (inches per second squared). Output is in millivolts.
+ */
+class Feedforward
+{
+private:
+    double kS;
+    double kV;
+    double kA;
+
+public:
+    Feedforward(double kS, double kV, double kA);
+    double getOutput(double velocity, double acceleration);
+    void setGains(double kS, double kV, double kA);
+};
@@ -0,0 +1,48 @@
+#define MAX_GAIN_PROFILES 32
+#define GAIN_PROFILE_NAME_LENGTH 16
+
+/**
+ * @brief A named set of gains
+ * 
+ */
+struct GainProfile
+{
+    int id;
+    char name[GAIN_PROFILE_NAME_LENGTH];
+    double kP;
+    double kI;
+    double kD;
+    int minSpeed;
+};
+
+/**
+ * @brief Gain Profiles Class Declaration
+ * 
+ * Named gains read once from a text file on the SD card, so gains can be
+ * changed between matches without rebuilding. Each line is:
+ * 
+ * id name kP kI kD minSpeed
+ * 
+ * ex. "3 longTurn 1.1 0 0.05 15". Lines starting with # are ignored. Use
+ * the id with drive.withGainProfile() or drive.withTurnGainProfile().
+ */
+class GainProfiles
+{
+private:
+    GainProfile profiles[MAX_GAIN_PROFILES];
+    int count;
+
+    int indexOf(int id);
+
+public:
+    GainProfiles();
+    int load(const char *path);
+    bool save(const char *path);
+    const GainProfile *get(int id);
+    int getId(const char *name);
+    bool set(int id, const char *name, double kP, double kI, double kD, int minSpeed);
+    int size();
+};
+
+extern GainProfiles gainProfiles;
+extern const char *GAIN_PROFILES_FILE;
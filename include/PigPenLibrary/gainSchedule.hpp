@@ -0,0 +1,39 @@
+/**
+ * @brief One row of a gain schedule
+ * 
+ * magnitude is the size of the movement the gains were tuned for
+ * (inches for moves, degrees for turns).
+ */
+struct GainPoint
+{
+    double magnitude;
+    double kP;
+    double kI;
+    double kD;
+    int minSpeed;
+};
+
+/**
+ * @brief Gain Schedule Class Declaration
+ * 
+ * Interpolates gains from a table sorted by magnitude. Movements shorter or
+ * longer than the table use its first or last row.
+ * 
+ * Optionally kP is also scaled by the current error: inside errorBand it
+ * moves linearly from 1 (at the band edge) to errorScale (at zero error),
+ * ex. errorScale 1.5 to push harder through the last few inches.
+ */
+class GainSchedule
+{
+private:
+    const GainPoint *points;
+    int length;
+    double errorBand;
+    double errorScale;
+
+public:
+    GainSchedule(const GainPoint *points, int length, double errorBand = 0, double errorScale = 1);
+    void setTable(const GainPoint *points, int length);
+    GainPoint lookup(double magnitude);
+    void apply(PIDController &pid, double magnitude, int minSpeed = -1);
+};
@@ -0,0 +1,71 @@
+#define MAX_METRICS 32
+
+/**
+ * @brief Response Metrics Class Declaration
+ * 
+ * Records how a controller responded to one command from the errors it
+ * sees. The first update() after reset() is the initial error.
+ * 
+ * riseTime: ms until 90% of the initial error was closed (-1 if never)
+ * overshoot: furthest the error went past the target (error units)
+ * integralAbsoluteError: sum of |error| * dt (error units * seconds)
+ * finalError: the last error seen
+ */
+class ResponseMetrics
+{
+private:
+    bool started;
+    std::uint32_t startTime;
+    std::uint32_t lastTime;
+    double initialError;
+
+public:
+    int riseTime;
+    double overshoot;
+    double integralAbsoluteError;
+    double finalError;
+
+    ResponseMetrics();
+    void reset();
+    void update(double error);
+};
+
+/**
+ * @brief One command's metrics in the stats table
+ * 
+ */
+struct MetricsRecord
+{
+    const char *name;
+    int riseTime;
+    double overshoot;
+    double integralAbsoluteError;
+    int settleTime;
+    double finalError;
+    int duration;
+    int exitReason;
+};
+
+/**
+ * @brief Metrics Table Class Declaration
+ * 
+ * Keeps the last MAX_METRICS records, overwriting the oldest.
+ */
+class MetricsTable
+{
+private:
+    MetricsRecord records[MAX_METRICS];
+    int count;
+    int next;
+
+public:
+    MetricsTable();
+    void add(MetricsRecord record);
+    MetricsRecord get(int index);
+    int size();
+    void clear();
+    void print();
+    bool save(const char *path);
+};
+
+extern MetricsTable motionMetrics;
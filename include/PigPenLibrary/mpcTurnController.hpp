@@ -0,0 +1,37 @@
+/**
+ * @brief MPC Turn Controller Class Declaration
+ * 
+ * Model predictive controller for point turns using the identified model
+ * 
+ * angular acceleration = a * power - b * angular velocity
+ * 
+ * (degrees, seconds, power -127 to 127). The quadratic cost of the turn
+ * over the horizon is solved once, by a Riccati recursion in the
+ * constructor, into two gains, so each control step is a 2-element dot
+ * product of the gains with [error, angular velocity].
+ * 
+ * The power is then clamped to the motor's voltage range and to a current
+ * limit: current is roughly proportional to the power left over after the
+ * back-EMF of the current speed (b / a * angular velocity).
+ * 
+ * IDENTIFYING a AND b:
+ * Turn in place at full power and log getAngularVelocity(). With top speed
+ * w (deg/s) and time to reach 63% of it tau (s): b = 1 / tau, a = w * b / 127.
+ */
+class MPCTurnController
+{
+private:
+    double a;
+    double b;
+    double maxCurrentPower;
+    double kAngle;
+    double kVelocity;
+
+public:
+    MPCTurnController(double a, double b, double qAngle, double qVelocity, double r, int horizon, double maxCurrentPower);
+    double getOutput(double target, double current);
+    double getOutput(double error);
+    void reset();
+    double getAngleGain();
+    double getVelocityGain();
+};
@@ -7,11 +7,14 @@ extern const int TICS_PER_REVOLUTION;
 void odometryStartTask(bool reset = true);
 void odometryStopTask();
 
-void calculate_position(void *parameter);
+void odometryStep();
+void odometryTelemetry();
 double getX();
 double getY();
 double getTheta();
 double getThetaRadians();
+double getVelocity();
+double getAngularVelocity();
 void resetOdometry();
 void setTheta(int degrees);
 void setCoordinates(int x, int y, int theta);
@@ -0,0 +1,44 @@
+/**
+ * @brief Trajectory point structure (see Drive::followTrajectory())
+ * 
+ * Positions are in inches and use the same field frame as odometry.
+ * theta is in degrees and angularVelocity in degrees per second, both
+ * using the getTheta() convention (clockwise positive).
+ */
+struct TrajectoryPoint
+{
+    double x;
+    double y;
+    double theta;
+    double velocity;
+    double angularVelocity;
+};
+
+/**
+ * @brief Wheel velocity targets in inches per second
+ * 
+ */
+struct WheelVelocities
+{
+    double left;
+    double right;
+};
+
+/**
+ * @brief RAMSETE Controller Class Declaration
+ * 
+ * Nonlinear trajectory tracking controller. Converts a reference pose and
+ * velocity plus the current odometry pose into left/right wheel velocities.
+ */
+class RamseteController
+{
+private:
+    double b;
+    double zeta;
+
+public:
+    RamseteController(double b, double zeta);
+    WheelVelocities getOutput(TrajectoryPoint reference, double x, double y, double theta);
+};
+
+TrajectoryPoint trajectoryPointFromSegments(const Segment *segments, int index, int length);
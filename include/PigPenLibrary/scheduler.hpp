@@ -0,0 +1,62 @@
+#define MAX_JOBS 16
+
+/**
+ * @brief A periodic job and its timing statistics
+ * 
+ * A deadline is missed when a step is still running (or hasn't started)
+ * when its next period begins. Execution times are in microseconds.
+ */
+struct Job
+{
+    const char *name;
+    int period;
+    void (*step)(); //nullptr for external jobs (see addExternalJob())
+    volatile bool enabled;
+    std::uint32_t priority;
+    pros::Task *task;
+
+    int runs;
+    int deadlineMisses;
+    std::uint32_t lastExecutionTime;
+    std::uint32_t worstExecutionTime;
+};
+
+/**
+ * @brief Rate-Monotonic Scheduler Class Declaration
+ * 
+ * Runs each registered job in its own task every period (ms). Priorities
+ * are assigned rate-monotonically: the shorter a job's period, the higher
+ * its priority. Adding a job re-assigns every job's priority.
+ * 
+ * Tasks that pace themselves, like the drive task, are registered with
+ * addExternalJob() so they fit in the same ordering, and report each step
+ * with recordRun() so they are timed like any other job.
+ * 
+ * EXAMPLE:
+ * void intakeStep() { ... }
+ * scheduler.addJob("intake", 10, intakeStep);
+ */
+class Scheduler
+{
+private:
+    Job jobs[MAX_JOBS];
+    int count;
+
+    static void runJob(void *parameter);
+    Job *newJob(const char *name, int period, void (*step)());
+    void assignPriorities();
+
+public:
+    Scheduler();
+    int addJob(const char *name, int period, void (*step)());
+    int addExternalJob(const char *name, int period, pros::Task *task);
+    void setTask(int id, pros::Task *task);
+    void recordRun(int id, std::uint32_t executionTime, bool missed);
+    void setEnabled(int id, bool enabled);
+    std::uint32_t priorityFor(int period);
+    Job getJob(int id);
+    int size();
+    void printStats();
+};
+
+extern Scheduler scheduler;
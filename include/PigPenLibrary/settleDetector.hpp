@@ -0,0 +1,43 @@
+/**
+ * @brief Settle Detector Class Declaration
+ * 
+ * Decides when a movement has settled. It is settled when any of these
+ * hold for their minimum time (in milliseconds):
+ * 1. |error| < errorTolerance and |derivative| < derivativeTolerance
+ *    (derivative is in error units per second)
+ * 2. |error| < smallError
+ * 3. |error| < largeError
+ * 
+ * Set a window's time to 0 to disable it.
+ */
+class SettleDetector
+{
+private:
+    double errorTolerance;
+    double derivativeTolerance;
+    int settleTime;
+    double smallError;
+    int smallErrorTime;
+    double largeError;
+    int largeErrorTime;
+
+    double prevError;
+    double derivative;
+    std::uint32_t prevTime;
+    std::uint32_t startTime;
+    std::uint32_t toleranceEnteredTime;
+    std::uint32_t smallEnteredTime;
+    std::uint32_t largeEnteredTime;
+    bool inTolerance;
+    bool inSmall;
+    bool inLarge;
+    bool firstStep;
+    int timeToSettle;
+
+public:
+    SettleDetector(double errorTolerance, double derivativeTolerance, int settleTime,
+                   double smallError, int smallErrorTime, double largeError, int largeErrorTime);
+    bool isSettled(double error);
+    void reset();
+    int getSettleTime();
+};
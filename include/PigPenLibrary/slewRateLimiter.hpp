@@ -0,0 +1,27 @@
+/**
+ * @brief Slew Rate Limiter Class Declaration
+ * 
+ * Limits how fast an output can change, in units per second. Speeding up
+ * and slowing down have separate limits. step() never blocks; the change
+ * allowed is based on the time since the last call.
+ */
+class SlewRateLimiter
+{
+private:
+    double maxRise;
+    double maxFall;
+    double output;
+    std::uint32_t lastTime;
+
+    double DEFAULT_MAXRISE;
+    double DEFAULT_MAXFALL;
+
+public:
+    SlewRateLimiter(double maxRise, double maxFall);
+    double step(double target);
+    void reset(double value = 0);
+    void setLimits(double maxRise, double maxFall);
+    void setMaxRise(double maxRise);
+    void resetLimitsToDefaults();
+    double getOutput();
+};
@@ -1 +1,2 @@
-void wait(int duration);
\ No newline at end of file
+void wait(int duration);
+double wrapAngle(double degrees);
\ No newline at end of file
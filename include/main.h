@@ -21,11 +21,23 @@
 /****************************************************************************
  * @brief PigPen Library #include statements
  */
+#include "PigPenLibrary/scheduler.hpp"
+#include "PigPenLibrary/commandChannel.hpp"
 #include "PigPenLibrary/odometry.hpp"
 #include "PigPenLibrary/Configuration/sensorConfig.hpp"
 #include "PigPenLibrary/Configuration/robotConfig.hpp"
-#include "PigPenLibrary/drive.hpp"
+#include "PigPenLibrary/ramsete.hpp"
+#include "PigPenLibrary/feedforward.hpp"
+#include "PigPenLibrary/slewRateLimiter.hpp"
+#include "PigPenLibrary/settleDetector.hpp"
+#include "PigPenLibrary/motionMetrics.hpp"
 #include "PigPenLibrary/PIDController.hpp"
+#include "PigPenLibrary/controllers.hpp"
+#include "PigPenLibrary/gainSchedule.hpp"
+#include "PigPenLibrary/gainProfiles.hpp"
+#include "PigPenLibrary/mpcTurnController.hpp"
+#include "PigPenLibrary/drive.hpp"
+#include "PigPenLibrary/autoTuner.hpp"
 #include "PigPenLibrary/utilities.hpp"
 /***************************************************************************/
 
@@ -36,3 +36,21 @@ const double LEFT_OFFSET = 5.95;
 const double RIGHT_OFFSET = 5.95;
 const double REAR_OFFSET = 5.75;
 /***************************************************************************/
+
+/***************************************************************************
+ * @brief Drivetrain Robot Configuration
+ * 
+ * These constants describe the powered drive wheels (not the tracking 
+ * wheels) and are used to convert wheel velocities in inches per second
+ * into motor velocities. 
+ * 
+ * DRIVE_GEAR_RATIO is the drive wheel RPM divided by the motor RPM.
+ * Ex. A 600 RPM motor driving a 36 tooth gear into a 60 tooth gear is 0.6
+ * 
+ * DRIVE_TRACK_WIDTH is measured from the center of the left wheels to the
+ * center of the right wheels. 
+ */
+const double DRIVE_WHEEL_DIAMETER = 3.25;
+const double DRIVE_GEAR_RATIO = 0.6;
+const double DRIVE_TRACK_WIDTH = 12.5;
+/***************************************************************************/
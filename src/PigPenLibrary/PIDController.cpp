@@ -1,71 +1,147 @@
 #include "main.h"
 
-PIDController::PIDController(double inKP, double inKI, double inKD, int inMinSpeed)
+PIDController::PIDController(double inKP, double inKI, double inKD, int inMinSpeed, double inMaxOutput)
 {
     kP = inKP;
     kI = inKI;
     kD = inKD;
     minSpeed = inMinSpeed;
+    maxOutput = inMaxOutput;
+
+    //Integrate everywhere, limited only by maxOutput (see setIntegralLimits())
+    integralZone = 0;
+    maxIntegral = 0;
+    //Weight of each new derivative sample (see setDerivativeFilter())
+    derivativeFilter = 0.5;
+    //kP isn't scaled by error (see setErrorScaling())
+    errorBand = 0;
+    errorScale = 1;
+    metrics = nullptr;
 
     //Stores initial values as defaults
     DEFAULT_KP = inKP;
     DEFAULT_KI = inKI;
     DEFAULT_KD = inKD;
     DEFAULT_MINSPEED = inMinSpeed;
+
+    error = 0;
+    reset();
 }
 
 PIDController::PIDController(double inKP, int inMinSpeed)
+    : PIDController(inKP, 0, 0, inMinSpeed)
 {
-    kP = inKP;
-    minSpeed = inMinSpeed;
-
-    DEFAULT_KP = inKP;
 }
 
-int PIDController::getOutput(int target, int current)
+/**
+ * @brief Calculates the output for a target and the current measurement
+ * 
+ * The derivative is taken on the measurement (not the error) so changing
+ * the target doesn't cause a spike in output.
+ * 
+ * @param target 
+ * @param current 
+ * @return double 
+ */
+double PIDController::getOutput(double target, double current)
 {
+    return calculate(target - current, current);
+}
 
-    double prevError = 0;
+/**
+ * @brief Calculates the output from an error alone (ex. a wrapped angle)
+ * 
+ * @param inError 
+ * @return double 
+ */
+double PIDController::getOutput(double inError)
+{
+    //With a fixed target the measurement changes opposite to the error
+    return calculate(inError, -inError);
+}
 
-    error = (target - current);
+double PIDController::calculate(double inError, double measurement)
+{
+    error = inError;
+    if (metrics != nullptr)
+    {
+        metrics->update(error);
+    }
 
-    int integral = integral + error;
+    std::uint64_t now = pros::micros();
+    double dt = (now - prevTime) / 1000000.0;
+    prevTime = now;
 
-    if (error == 0)
+    if (firstStep || dt <= 0)
     {
-        integral = 0;
+        //No history yet, so only the P term is meaningful
+        derivative = 0;
+        firstStep = false;
     }
-
-    if (abs(error) > 40)
+    else
     {
-        integral = 0;
+        //Low-pass filtered derivative of the measurement
+        double rawDerivative = -(measurement - prevMeasurement) / dt;
+        derivative = derivativeFilter * rawDerivative + (1 - derivativeFilter) * derivative;
+
+        //Only integrate inside the integral zone, and drop it when the error changes sign
+        if (integralZone > 0 && fabs(error) > integralZone)
+        {
+            integral = 0;
+        }
+        else if ((error > 0 && integral < 0) || (error < 0 && integral > 0))
+        {
+            integral = 0;
+        }
+        else
+        {
+            integral += error * dt;
+        }
     }
+    prevMeasurement = measurement;
 
-    int derivative = error - prevError;
+    //Anti-windup: the I term alone can never exceed maxIntegral (or maxOutput)
+    double integralLimit = maxIntegral > 0 ? maxIntegral : maxOutput;
+    if (kI != 0 && integralLimit > 0)
+    {
+        integral = fmax(-integralLimit / fabs(kI), fmin(integralLimit / fabs(kI), integral));
+    }
 
-    prevError = error;
+    //kP blends toward errorScale * kP as the error shrinks inside errorBand
+    double scaledKP = kP;
+    if (errorBand > 0 && fabs(error) < errorBand)
+    {
+        scaledKP *= errorScale + (1 - errorScale) * fabs(error) / errorBand;
+    }
 
     //power output calculation
-    int power = (error * kP + derivative * kI + integral * kD);
+    double power = error * scaledKP + integral * kI + derivative * kD;
 
-    //Power defaults to our minimum speed if power generates a value < minSpeed
-    if (power <= minSpeed && power <= 0 && fabs(error) < 0.5)
-    {
-        return power;
-    }
-    else if (power >= -minSpeed && power <= 0 && fabs(error) < 0.5)
+    //Power defaults to our minimum speed unless we are essentially at the target
+    if (fabs(error) >= 0.5 && fabs(power) < minSpeed)
     {
-        return power;
+        power = error > 0 ? minSpeed : -minSpeed;
     }
-    else if (power <= minSpeed && power >= 0)
+
+    if (maxOutput > 0)
     {
-        power = minSpeed;
+        power = fmax(-maxOutput, fmin(maxOutput, power));
     }
-    else if (power >= -minSpeed && power <= 0)
+    return power;
+}
+
+//Clears the integral and derivative history; call at the start of each movement
+void PIDController::reset()
+{
+    integral = 0;
+    derivative = 0;
+    prevMeasurement = 0;
+    prevTime = pros::micros();
+    firstStep = true;
+    if (metrics != nullptr)
     {
-        power = -minSpeed;
+        metrics->reset();
     }
-    return power;
 }
 
 void PIDController::setGains(double inKP, double inKI, double inKD, int inMinSpeed)
@@ -76,9 +152,57 @@ void PIDController::setGains(double inKP, double inKI, double inKD, int inMinSpe
     minSpeed = inMinSpeed;
 }
 
+/**
+ * @brief Configure integral anti-windup
+ * 
+ * @param inIntegralZone the integral only builds while |error| is below this (0 = always)
+ * @param inMaxIntegral largest output the I term can contribute (0 = maxOutput)
+ */
+void PIDController::setIntegralLimits(double inIntegralZone, double inMaxIntegral)
+{
+    integralZone = inIntegralZone;
+    maxIntegral = inMaxIntegral;
+}
+
+/**
+ * @brief Configure the derivative low-pass filter
+ * 
+ * @param inDerivativeFilter weight of each new sample (1 = unfiltered, smaller = smoother)
+ */
+void PIDController::setDerivativeFilter(double inDerivativeFilter)
+{
+    derivativeFilter = fmax(0, fmin(1, inDerivativeFilter));
+}
+
+/**
+ * @brief Scale kP by the current error
+ * 
+ * @param inErrorBand kP is scaled while |error| is below this (0 = off)
+ * @param inErrorScale kP multiplier at zero error
+ */
+void PIDController::setErrorScaling(double inErrorBand, double inErrorScale)
+{
+    errorBand = inErrorBand;
+    errorScale = inErrorScale;
+}
+
+/**
+ * @brief Record this controller's response to each command
+ * 
+ * metrics is restarted by reset() (at the start of every movement).
+ * 
+ * @param inMetrics where to record, or nullptr to stop recording
+ */
+void PIDController::recordMetrics(ResponseMetrics *inMetrics)
+{
+    metrics = inMetrics;
+}
+
 //Reset gains to stored defaults (see constructor)
 void PIDController::resetGainsToDefaults()
 {
+    errorBand = 0;
+    errorScale = 1;
     kP = DEFAULT_KP;
     kI = DEFAULT_KI;
     kD = DEFAULT_KD;
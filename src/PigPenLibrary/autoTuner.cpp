@@ -0,0 +1,252 @@
+#include "main.h"
+
+//Saved gains are loaded from here at startup (see initialize.cpp)
+const char *TUNED_GAINS_FILE = "/usd/tuned_gains.txt";
+
+/**
+ * @brief Construct a new Relay Auto Tuner
+ * 
+ * @param inRelayPower motor power (0 to 127) applied in each direction
+ * @param inHysteresis error (degrees or inches) the relay must cross before switching
+ * @param inCycles oscillations to average after the first one
+ * @param inTimeout ms before the test gives up
+ */
+RelayAutoTuner::RelayAutoTuner(double inRelayPower, double inHysteresis, int inCycles, int inTimeout)
+{
+    relayPower = inRelayPower;
+    hysteresis = inHysteresis;
+    cycles = inCycles;
+    timeout = inTimeout;
+}
+
+/**
+ * @brief Oscillate the chassis and measure its ultimate gain and period
+ * 
+ * TUNE_TURN rocks in place about the starting heading; TUNE_MOVE rocks
+ * forward and back about the starting position.
+ * 
+ * @param tuneType TUNE_TURN or TUNE_MOVE
+ * @return RelayResult 
+ */
+RelayResult RelayAutoTuner::run(int tuneType)
+{
+    Drive::stopMotions();
+
+    double startX = getX();
+    double startY = getY();
+    double startTheta = getTheta();
+    double startThetaRadians = getThetaRadians();
+
+    double output = relayPower;
+    double maxMeasurement = 0;
+    double minMeasurement = 0;
+    double amplitudeSum = 0;
+    double periodSum = 0;
+    int measuredCycles = 0;
+    std::uint32_t lastRise = 0;
+    std::uint32_t startTime = pros::millis();
+    std::uint32_t now = startTime;
+
+    //The first cycle only gets the oscillation going, so it isn't measured
+    while (measuredCycles < cycles && (int)(now - startTime) < timeout)
+    {
+        double measurement;
+        if (tuneType == TUNE_TURN)
+        {
+            measurement = getTheta() - startTheta;
+        }
+        else
+        {
+            //Distance along the starting heading
+            measurement = (getX() - startX) * cos(startThetaRadians) - (getY() - startY) * sin(startThetaRadians);
+        }
+        maxMeasurement = fmax(maxMeasurement, measurement);
+        minMeasurement = fmin(minMeasurement, measurement);
+
+        if (output < 0 && measurement < -hysteresis)
+        {
+            //Rising switch: one full cycle since the last one
+            output = relayPower;
+            if (lastRise != 0)
+            {
+                amplitudeSum += (maxMeasurement - minMeasurement) / 2;
+                periodSum += (now - lastRise) / 1000.0;
+                measuredCycles++;
+            }
+            lastRise = now;
+            maxMeasurement = measurement;
+            minMeasurement = measurement;
+        }
+        else if (output > 0 && measurement > hysteresis)
+        {
+            output = -relayPower;
+        }
+
+        if (tuneType == TUNE_TURN)
+        {
+            Drive::drivePower(output, -output);
+        }
+        else
+        {
+            Drive::drivePower(output, output);
+        }
+        pros::Task::delay_until(&now, MOTION_PERIOD);
+    }
+    Drive::drivePower(0, 0);
+
+    RelayResult result = {0, 0, false};
+    if (measuredCycles == cycles)
+    {
+        double amplitude = amplitudeSum / measuredCycles;
+        //Describing function of a relay with hysteresis
+        result.ultimateGain = 4 * relayPower / (PI * sqrt(fmax(amplitude * amplitude - hysteresis * hysteresis, 0.0001)));
+        result.ultimatePeriod = periodSum / measuredCycles;
+        result.success = true;
+    }
+    printf("Relay test: Ku %.3f Tu %.3fs (%s)\n", result.ultimateGain, result.ultimatePeriod, result.success ? "ok" : "timed out");
+    return result;
+}
+
+/**
+ * @brief Propose gains from a relay test
+ * 
+ * TUNING_RULE_ZIEGLER_NICHOLS: fastest, expect some overshoot
+ * TUNING_RULE_TYREUS_LUYBEN: more damped, a good default for a drivetrain
+ * TUNING_RULE_NO_OVERSHOOT: slowest, for movements that must not pass the target
+ * 
+ * @param result 
+ * @param rule 
+ * @param minSpeed 
+ * @return GainPoint 
+ */
+GainPoint RelayAutoTuner::tuneGains(RelayResult result, int rule, int minSpeed)
+{
+    double ku = result.ultimateGain;
+    double tu = result.ultimatePeriod;
+    double kP, ti, td;
+
+    switch (rule)
+    {
+    case TUNING_RULE_TYREUS_LUYBEN:
+        kP = ku / 2.2;
+        ti = 2.2 * tu;
+        td = tu / 6.3;
+        break;
+    case TUNING_RULE_NO_OVERSHOOT:
+        kP = 0.2 * ku;
+        ti = tu / 2;
+        td = tu / 3;
+        break;
+    default:
+        kP = 0.6 * ku;
+        ti = tu / 2;
+        td = tu / 8;
+        break;
+    }
+    return {0, kP, kP / ti, kP * td, minSpeed};
+}
+
+//Print the gains each rule proposes
+void RelayAutoTuner::printProposals(RelayResult result, int minSpeed)
+{
+    const char *names[3] = {"Ziegler-Nichols", "Tyreus-Luyben", "No overshoot"};
+    for (int rule = 0; rule < 3; rule++)
+    {
+        GainPoint gains = tuneGains(result, rule, minSpeed);
+        printf("%-16s kP %.4f kI %.4f kD %.4f minSpeed %d\n", names[rule], gains.kP, gains.kI, gains.kD, gains.minSpeed);
+    }
+}
+
+/**
+ * @brief Save gains to the SD card so they are used from the next startup
+ * 
+ * Move gains are in power per inch (from TUNE_MOVE). The other type's
+ * saved gains are kept.
+ * 
+ * @param gains 
+ * @param tuneType TUNE_TURN or TUNE_MOVE
+ * @return true if the file was written
+ */
+bool RelayAutoTuner::saveGains(GainPoint gains, int tuneType)
+{
+    GainPoint saved[2] = {};
+    bool found[2] = {false, false};
+
+    FILE *file = fopen(TUNED_GAINS_FILE, "r");
+    if (file != nullptr)
+    {
+        char name[8];
+        GainPoint row = {};
+        while (fscanf(file, "%7s %lf %lf %lf %d", name, &row.kP, &row.kI, &row.kD, &row.minSpeed) == 5)
+        {
+            int type = strcmp(name, "turn") == 0 ? TUNE_TURN : TUNE_MOVE;
+            saved[type] = row;
+            found[type] = true;
+        }
+        fclose(file);
+    }
+    saved[tuneType] = gains;
+    found[tuneType] = true;
+
+    file = fopen(TUNED_GAINS_FILE, "w");
+    if (file == nullptr)
+    {
+        printf("Could not write %s (is an SD card inserted?)\n", TUNED_GAINS_FILE);
+        return false;
+    }
+    const char *names[2] = {"turn", "move"};
+    for (int type = 0; type < 2; type++)
+    {
+        if (found[type])
+        {
+            fprintf(file, "%s %f %f %f %d\n", names[type], saved[type].kP, saved[type].kI, saved[type].kD, saved[type].minSpeed);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+/**
+ * @brief Save gains as a named gain profile (see gainProfiles.hpp)
+ * 
+ * Use this to keep tuned gains for a particular movement instead of
+ * replacing the defaults. The profile can be used straight away.
+ * 
+ * @param gains 
+ * @param id 
+ * @param name up to 15 characters, no spaces
+ * @return true if the profile file was written
+ */
+bool RelayAutoTuner::saveProfile(GainPoint gains, int id, const char *name)
+{
+    if (!gainProfiles.set(id, name, gains.kP, gains.kI, gains.kD, gains.minSpeed))
+    {
+        return false;
+    }
+    return gainProfiles.save(GAIN_PROFILES_FILE);
+}
+
+//Use any gains saved by saveGains() in place of the default gain schedules
+void RelayAutoTuner::loadSavedGains()
+{
+    FILE *file = fopen(TUNED_GAINS_FILE, "r");
+    if (file == nullptr)
+    {
+        return;
+    }
+
+    char name[8];
+    GainPoint row = {};
+    while (fscanf(file, "%7s %lf %lf %lf %d", name, &row.kP, &row.kI, &row.kD, &row.minSpeed) == 5)
+    {
+        if (strcmp(name, "turn") == 0)
+        {
+            Drive::setTunedTurnGains(row);
+        }
+        else if (strcmp(name, "move") == 0)
+        {
+            Drive::setTunedMoveGains(row);
+        }
+    }
+    fclose(file);
+}
@@ -50,142 +50,761 @@ pros::Motor rightBack(1, pros::E_MOTOR_GEARSET_06, false, pros::E_MOTOR_ENCODER_
  */
 PIDController movePID(0.15, 0, 0, 15);
 PIDController turnPID(1.25, 0, 0, 15);
-PIDController sweepTurnWithThreshholdPID(1.75, 0, 0, 80);
+
+//Fixed loops are composed from only the terms they use (see controllers.hpp)
+ComposedController<terms::P, terms::MinOutput> sweepTurnWithThreshholdPID(terms::P(1.75), terms::MinOutput(80));
+
+//Heading hold for straight moves: power difference between sides per degree of error
+ComposedController<terms::P> headingPID(terms::P(4));
+
+//moveToPose steering toward the carrot; no minimum output so small errors don't make it weave
+ComposedController<terms::P> poseSteerPID(terms::P(1.25));
+/***************************************************************************/
+
+/***************************************************************************
+ * @brief Chassis Gain Schedules
+ * 
+ * Each row is {movement size, kP, kI, kD, minSpeed}, sorted by size (inches
+ * for moves, degrees for turns). Gains are interpolated between rows when
+ * a movement starts, so short and long movements each get gains tuned for
+ * them. Schedules are skipped when withGains()/withTurnGains() is used.
+ * 
+ * The last two GainSchedule parameters scale kP near the target: inside
+ * the error band kP blends to (scale * kP) at zero error. Fluid movements
+ * keep their minSpeed of 75.
+ * 
+ * Gains saved by the relay auto tuner (see autoTuner.hpp) replace the
+ * move and turn schedules at startup.
+ */
+const GainPoint moveDistanceGains[] = {
+    {6, 0.2, 0, 0, 20},
+    {24, 0.15, 0, 0, 15},
+    {72, 0.12, 0, 0, 15}};
+const GainPoint moveCoordinateGains[] = {
+    {6, 8, 0, 0, 30},
+    {24, 6, 0, 0, 30},
+    {72, 5, 0, 0, 30}};
+const GainPoint moveBackXGains[] = {
+    {6, 7, 0, 0, 30},
+    {24, 5, 0, 0, 30},
+    {72, 4.5, 0, 0, 30}};
+const GainPoint turnGains[] = {
+    {5, 2.5, 0, 0, 20},
+    {45, 1.6, 0, 0, 15},
+    {90, 1.25, 0, 0, 15},
+    {180, 1, 0, 0, 15}};
+const GainPoint sweepGains[] = {
+    {15, 2, 0, 0, 20},
+    {90, 1.25, 0, 0, 15},
+    {180, 1.1, 0, 0, 15}};
+
+GainSchedule moveDistanceSchedule(moveDistanceGains, 3);
+GainSchedule moveCoordinateSchedule(moveCoordinateGains, 3);
+GainSchedule moveBackXSchedule(moveBackXGains, 3);
+GainSchedule turnSchedule(turnGains, 4, 3, 1.5);
+GainSchedule sweepSchedule(sweepGains, 3);
+/***************************************************************************/
+
+/***************************************************************************
+ * @brief Chassis Model Predictive Turn Controller Constructor
+ * 
+ * PARAMETERS (see mpcTurnController.hpp):
+ * 1. a and 2. b: identified turning model
+ * 3. Heading error cost, 4. angular velocity cost and 5. power cost
+ * 6. Horizon in control steps
+ * 7. Current limit (power above back-EMF)
+ * 
+ * With USE_MPC_TURNS point turns use turnMPC instead of turnPID. Use
+ * withMPC() to choose for a single turn. Sweeps always use turnPID.
+ */
+const bool USE_MPC_TURNS = false;
+MPCTurnController turnMPC(29.5, 8.33, 1, 0, 0.01, 100, 100);
+/***************************************************************************/
+
+/***************************************************************************
+ * @brief Chassis Default Settle Detector Constructors
+ * 
+ * PARAMETERS (see settleDetector.hpp):
+ * 1. Error tolerance
+ * 2. Derivative tolerance (error units per second)
+ * 3. Time (ms) both tolerances must be held
+ * 4. Small error window and 5. the time (ms) it must be held
+ * 6. Large error window and 7. the time (ms) it must be held
+ * 
+ * Turns are in degrees and moves are in inches. Use withSettle() to use a
+ * different detector for one movement. Each movement's settle time is
+ * printed to the terminal so wasted dwell time can be tuned out.
+ */
+SettleDetector turnSettle(2.5, 10, 50, 1, 100, 4, 500);
+SettleDetector moveSettle(0.5, 2, 50, 0.25, 100, 1, 300);
+/***************************************************************************/
+
+/***************************************************************************
+ * @brief Chassis Stall Detection Configuration
+ * 
+ * A movement is aborted as stalled when, for STALL_TIME milliseconds, the
+ * drive motors draw more than STALL_CURRENT (mA) while spinning slower
+ * than STALL_RPM and odometry shows the robot isn't moving. Stalls are not
+ * checked for the first STALL_IGNORE_TIME ms while the robot accelerates.
+ */
+const int STALL_CURRENT = 1800;
+const double STALL_RPM = 20;
+const int STALL_TIME = 250;
+const int STALL_IGNORE_TIME = 300;
+
+//Longest stopMotions() waits (ms) for a cancelled movement to finish its control step
+const int STOP_TIMEOUT = 100;
+/***************************************************************************/
+
+/***************************************************************************
+ * @brief Chassis Output Mode Configuration
+ * 
+ * By default movements send percent power to the motors, so the response
+ * of the tuned gains changes with battery voltage and load. With
+ * CASCADED_CONTROL the power from the position/heading loops becomes a
+ * velocity target (power / 127 of the cartridge's top RPM) held by the
+ * motors' internal velocity loop. Re-tune the gains after switching modes.
+ * Use withCascade() to change the mode for one movement. Driver control
+ * always uses percent power.
+ */
+const bool CASCADED_CONTROL = false;
+/***************************************************************************/
+
+/***************************************************************************
+ * @brief Chassis Trajectory Controller Constructor
+ * 
+ * b and zeta are the standard RAMSETE tuning constants. b is scaled for
+ * inches (2.0 in meters is roughly 0.0013 in inches). Larger values of b
+ * correct position error more aggressively, and zeta (0-1) adds damping.
+ */
+RamseteController ramsete(0.0013, 0.7);
+/***************************************************************************/
+
+/***************************************************************************
+ * @brief Chassis Velocity Control Constructors
+ * 
+ * The feedforward predicts the voltage (mV) needed for a wheel velocity:
+ * 1. kS: voltage needed to overcome static friction
+ * 2. kV: voltage per inch per second of wheel velocity
+ * 3. kA: voltage per inch per second squared of wheel acceleration
+ * 
+ * The velocity PIDControllers correct the remaining error in motor RPM and
+ * output millivolts (the last parameter limits them to +-12000 mV). Tune
+ * the feedforward first, then add feedback.
+ */
+Feedforward driveFeedforward(600, 190, 20);
+PIDController leftVelocityPID(20, 0, 0, 0, 12000);
+PIDController rightVelocityPID(20, 0, 0, 0, 12000);
+/***************************************************************************/
+
+/***************************************************************************
+ * @brief Chassis Slew Rate Limiter Constructors
+ * 
+ * Every drive output (autonomous and driver control) passes through these
+ * limiters. The parameters are the maximum change in motor power (-127 to
+ * 127) per second when speeding up and when slowing down. 
+ * 
+ * Ex. 600 takes about 0.2 seconds to go from 0 to full power
+ * 
+ * Moves with an accelStep override the speed up limit for that movement.
+ */
+SlewRateLimiter leftSlew(600, 2000);
+SlewRateLimiter rightSlew(600, 2000);
 /***************************************************************************/
 
 Drive drive;
-MoveTargets moveTargets;
-TurnTargets turnTargets;
 
-/* Move and Turn Tasks */
-pros::Task *move_task = nullptr;
-pros::Task *turn_task = nullptr;
+/* Drive task and the channel that carries commands to it (see sendCommand()) */
+pros::Task *drive_task = nullptr;
+int driveJob = -1;
+CommandChannel<MotionCommand, MOTION_QUEUE_SIZE> motionQueue;
 
-/* Acceleration Step Variables */
-int rightSideSpeed = 0;
-int leftSideSpeed = 0;
+/* Modifiers for the next command (caller's side) and the command being run (drive task's side) */
+MotionCommand nextCommand;
+MotionCommand activeCommand;
+
+/* Targets of the running command, only written by the drive task */
+MoveTargets moveTargets;
+TurnTargets turnTargets;
 
 // //Drive PIDControllers
 // PIDController movePID(0.15, 0, 0, 15);
 // PIDController turnPID(1.25, 0, 0, 15);
 
-bool moveComplete = false;
-bool turnComplete = false;
+/* Sequence numbers of the last command sent and the last one finished (see MotionHandle) */
+std::atomic<std::uint32_t> startedSequence{0};
+std::atomic<std::uint32_t> completedSequence{0};
+
+/*
+ * Tasks blocked in waitFor(), notified when a command finishes, and the
+ * competition status each started waiting in. PROS deletes the autonomous
+ * and opcontrol tasks when the mode changes, so a waiter from another mode
+ * may no longer exist and is never notified (see releaseWaiters()).
+ */
+pros::task_t volatile waiters[MAX_WAITERS] = {};
+std::uint8_t volatile waiterStatus[MAX_WAITERS] = {};
+
+//Longest a waiter sleeps before checking it still holds its slot
+const std::uint32_t WAITER_RECHECK_TIME = 100;
+
+/* Commands up to this sequence number are cancelled (see cancel()) */
+std::atomic<std::uint32_t> cancelledSequence{0};
+
+double correctionMultiplier = 1;
+
+/* Settle detector used by the current movement (see withSettle()) */
+SettleDetector *activeSettle = nullptr;
+std::uint32_t motionStartTime = 0;
+int lastSettleTime = -1;
+
+/* Timeout and stall detection for the current movement (see withTimeout()) */
+int activeTimeout = 0;
+std::uint32_t stallStartTime = 0;
+bool stalling = false;
+int exitReason = MOTION_COMPLETE;
+
+/* Event markers for the current movement (see withMarker()) */
+MotionMarker activeMarkers[MAX_MARKERS];
+int activeMarkerCount = 0;
+double distanceTraveled = 0;
+double prevMarkerX = 0;
+double prevMarkerY = 0;
+
+/* Minimum speed held through the end of a movement (see withExitSpeed()) */
+int exitSpeed = 0;
+
+/* Name of the current movement in the metrics table (see motionMetrics.hpp) */
+const char *motionName = "";
+const char *moveNames[] = {"move", "moveToXCoord", "moveBackToXCoord", "moveToYCoord", "moveBackToYCoord",
+                           "moveWithVision", "moveWithVisionToXCoord", "moveWithVisionToYCoord", "moveToPose", "moveToPoint"};
+const char *turnNames[] = {"turn", "sweepRight", "sweepRightThreshhold", "sweepLeft", "sweepLeftThreshhold",
+                           "sweepRightBack", "sweepRightBackThreshhold", "sweepLeftBack", "sweepLeftBackThreshhold"};
 
-double correctionMultiplier = 0.2;
+/* Output mode for the current movement (see withCascade()) */
+bool cascaded = false;
 
-//Move task helper methods
-void Drive::moveStartTask()
+/**
+ * @brief Mark command sequence finished and wake every waiting task
+ * 
+ * @param sequence 
+ */
+void Drive::signalComplete(std::uint32_t sequence)
 {
-    move_task = new pros::Task(moveTask);
+    completedSequence = sequence;
+    std::uint8_t status = pros::competition::get_status();
+    for (int i = 0; i < MAX_WAITERS; i++)
+    {
+        pros::task_t waiter = waiters[i];
+        if (waiter == nullptr)
+        {
+            continue;
+        }
+        if (waiterStatus[i] == status)
+        {
+            pros::c::task_notify(waiter);
+        }
+        else
+        {
+            //The waiter may have been deleted with its mode's task
+            __sync_bool_compare_and_swap(&waiters[i], waiter, nullptr);
+        }
+    }
 }
 
-void Drive::moveStopTask()
+/**
+ * @brief Empty every waiter slot (call when the competition mode changes)
+ * 
+ * Slots held by deleted autonomous or opcontrol tasks would otherwise never
+ * be freed. A waiter that is still running notices within
+ * WAITER_RECHECK_TIME ms and takes a slot again.
+ */
+void Drive::releaseWaiters()
 {
-    if (move_task != nullptr)
+    for (int i = 0; i < MAX_WAITERS; i++)
     {
-        move_task->remove();
-        delete move_task;
-        move_task = nullptr;
+        waiters[i] = nullptr;
     }
 }
 
-//turn task helper methods
-void Drive::turnStartTask()
+//Try to take a free waiter slot for the current task, -1 if they are all taken
+int claimWaiterSlot()
 {
-    turn_task = new pros::Task(turnTask);
+    pros::task_t self = pros::c::task_get_current();
+    for (int i = 0; i < MAX_WAITERS; i++)
+    {
+        if (__sync_bool_compare_and_swap(&waiters[i], nullptr, self))
+        {
+            waiterStatus[i] = pros::competition::get_status();
+            return i;
+        }
+    }
+    return -1;
 }
 
-void Drive::turnStopTask()
+/**
+ * @brief Block until command sequence has finished, without polling
+ * 
+ * The calling task takes a waiter slot and sleeps in notify_take() until
+ * signalComplete() notifies it, checking its slot every
+ * WAITER_RECHECK_TIME ms. If every slot is taken it checks every 5ms.
+ * 
+ * @param sequence 
+ * @param timeout ms to wait, or -1 to wait forever
+ * @return true if the command finished
+ */
+bool waitForSequence(std::uint32_t sequence, int timeout)
 {
-    if (turn_task != nullptr)
+    if (completedSequence >= sequence)
+    {
+        return true;
+    }
+
+    //Claim a slot before checking again so a completion can't be missed
+    pros::task_t self = pros::c::task_get_current();
+    int slot = claimWaiterSlot();
+
+    std::uint32_t start = pros::millis();
+    while (completedSequence < sequence)
     {
-        turn_task->remove();
-        delete turn_task;
-        turn_task = nullptr;
+        std::uint32_t wait = TIMEOUT_MAX;
+        if (timeout >= 0)
+        {
+            int remaining = timeout - (int)(pros::millis() - start);
+            if (remaining <= 0)
+            {
+                break;
+            }
+            wait = remaining;
+        }
+        pros::Task::notify_take(true, std::min(wait, slot == -1 ? (std::uint32_t)5 : WAITER_RECHECK_TIME));
+
+        //releaseWaiters() or signalComplete() may have emptied the slot
+        if (slot == -1 || waiters[slot] != self)
+        {
+            slot = claimWaiterSlot();
+        }
+    }
+
+    if (slot != -1)
+    {
+        __sync_bool_compare_and_swap(&waiters[slot], self, nullptr);
     }
+    return completedSequence >= sequence;
 }
 
-void Drive::left(int l)
+/**
+ * @brief Send the next command to the drive task, then wait for it unless async
+ * 
+ * The channel has a single producer, so start movements from one task
+ * (autonomous or opcontrol). Sending never waits on the control loop: a
+ * running movement sees the new command at its next control step and
+ * stops so the drive task can start it.
+ * 
+ * Movements run on the drive task, not the task that sent them, so they
+ * would outlive autonomous when competition control ends it. Each command
+ * records the competition status it was sent in and is cancelled as soon
+ * as the status changes.
+ * 
+ * @param async 
+ */
+void Drive::sendCommand(bool async)
 {
-    leftFront.move(l);
-    leftBack.move(l);
+    if (drive_task == nullptr)
+    {
+        driveStartTask();
+    }
+
+    std::uint32_t sequence = startedSequence + 1;
+    nextCommand.sequence = sequence;
+    nextCommand.status = pros::competition::get_status();
+
+    //Only full if the drive task is MOTION_QUEUE_SIZE commands behind
+    while (!motionQueue.push(nextCommand))
+    {
+        pros::delay(1);
+    }
+    //Published once queued, so a task deleted while waiting above leaves nothing to wait for
+    startedSequence = sequence;
+    nextCommand = MotionCommand();
+    drive_task->notify();
+
+    if (!async)
+    {
+        waitForSequence(sequence, -1);
+    }
 }
 
-void Drive::right(int r)
+/**
+ * @brief Start the drive task and register it as the scheduler's "drive" job
+ * 
+ */
+void Drive::driveStartTask()
 {
-    rightFront.move(r);
-    rightBack.move(r);
+    if (drive_task == nullptr)
+    {
+        drive_task = new pros::Task(driveTask, nullptr, scheduler.priorityFor(MOTION_PERIOD), TASK_STACK_DEPTH_DEFAULT, "drive");
+        driveJob = scheduler.addExternalJob("drive", MOTION_PERIOD, drive_task);
+    }
 }
 
-void Drive::slewRight(int speed, int accelStep)
+/**
+ * @brief Report one drive control step to the scheduler (see Scheduler::printStats())
+ * 
+ * Call just before the step's delay_until().
+ * 
+ * @param start pros::micros() when the step started
+ * @param release pros::millis() the step was released at
+ * @param period ms between steps
+ */
+void Drive::recordControlStep(std::uint32_t start, std::uint32_t release, int period)
+{
+    scheduler.recordRun(driveJob, pros::micros() - start, (int)(pros::millis() - release) >= period);
+}
+
+/**
+ * @brief Runs every movement, one command at a time
+ * 
+ * Sleeps until sendCommand() notifies it. A command that was cancelled,
+ * that a newer command replaced before it started, or that was sent in
+ * another competition mode is marked finished without running.
+ * 
+ * @param parameter 
+ */
+void Drive::driveTask(void *parameter)
 {
-    if (speed > rightSideSpeed)
+    while (true)
     {
-        rightSideSpeed++;
-        right(rightSideSpeed);
+        while (motionQueue.pop(activeCommand))
+        {
+            if (motionQueue.empty() && activeCommand.sequence > cancelledSequence &&
+                activeCommand.status == pros::competition::get_status())
+            {
+                runCommand();
+            }
+            else
+            {
+                exitReason = MOTION_CANCELLED;
+            }
+            signalComplete(activeCommand.sequence);
+        }
+        pros::Task::notify_take(true, TIMEOUT_MAX);
     }
-    else
+}
+
+/**
+ * @brief Apply activeCommand's modifiers and run its movement
+ * 
+ */
+void Drive::runCommand()
+{
+    moveTargets = activeCommand.move;
+    turnTargets = activeCommand.turn;
+    correctionMultiplier = activeCommand.correctionMultiplier;
+    exitSpeed = activeCommand.exitSpeed;
+
+    const GainOverride &moveGains = activeCommand.moveGains;
+    if (moveGains.enabled)
+    {
+        movePID.setGains(moveGains.kP, moveGains.kI, moveGains.kD, moveGains.minSpeed);
+    }
+    const GainOverride &turnGains = activeCommand.turnGains;
+    if (turnGains.enabled)
+    {
+        turnPID.setGains(turnGains.kP, turnGains.kI, turnGains.kD, turnGains.minSpeed);
+    }
+
+    switch (activeCommand.type)
+    {
+    case COMMAND_MOVE:
+        moveTask(nullptr);
+        break;
+    case COMMAND_TURN:
+        turnTask(nullptr);
+        break;
+    case COMMAND_TRAJECTORY:
+        trajectoryTask(activeCommand.points, activeCommand.length, activeCommand.dt);
+        break;
+    case COMMAND_SEGMENTS:
+        trajectoryTask(activeCommand.segments, activeCommand.length, activeCommand.dt);
+        break;
+    }
+
+    //set all modifiers back to defaults
+    movePID.resetGainsToDefaults();
+    turnPID.resetGainsToDefaults();
+}
+
+/**
+ * @brief Cancel the running movement and any sent before it (safe to call from any task)
+ * 
+ * Doesn't wait; the movement stops at its next control step. Use
+ * stopMotions() to wait until the drive is idle.
+ */
+void Drive::cancel()
+{
+    std::uint32_t sequence = startedSequence;
+    std::uint32_t cancelled = cancelledSequence;
+    //Never move the mark backwards if two tasks cancel at once
+    while (cancelled < sequence && !cancelledSequence.compare_exchange_weak(cancelled, sequence))
     {
-        right(speed);
     }
-    wait(accelStep);
 }
 
-void Drive::slewLeft(int speed, int accelStep)
+/**
+ * @brief Cancel every movement sent so far and wait for the drive to stop
+ * 
+ * Waits at most STOP_TIMEOUT ms. Don't call this from a marker callback;
+ * the callback runs inside the movement being cancelled.
+ * 
+ * @return true if the drive task stopped in time
+ */
+bool Drive::stopMotions()
+{
+    cancel();
+    return waitForSequence(startedSequence, STOP_TIMEOUT);
+}
+
+/**
+ * @brief Run a movement in moveTask() on the drive task
+ * 
+ * @param targets 
+ * @param async 
+ */
+void Drive::startMove(MoveTargets targets, bool async)
+{
+    nextCommand.type = COMMAND_MOVE;
+    nextCommand.move = targets;
+    sendCommand(async);
+}
+
+/**
+ * @brief Run a turn or sweep in turnTask() on the drive task
+ * 
+ * @param targets 
+ * @param async 
+ */
+void Drive::startTurn(TurnTargets targets, bool async)
 {
-    if (speed > leftSideSpeed)
+    nextCommand.type = COMMAND_TURN;
+    nextCommand.turn = targets;
+    sendCommand(async);
+}
+
+//Top speed of the drive motors' cartridge in RPM
+double driveMaxRPM()
+{
+    if (leftFront.get_gearing() == pros::E_MOTOR_GEARSET_06)
     {
-        leftSideSpeed++;
-        left(leftSideSpeed);
+        return 600;
     }
-    else
+    else if (leftFront.get_gearing() == pros::E_MOTOR_GEARSET_36)
     {
-        left(speed);
+        return 100;
     }
-    wait(accelStep);
+    return 200;
 }
 
-void Drive::slewRightBack(int speed, int accelStep)
+/**
+ * @brief Send a power (-127 to 127) to one side's motors
+ * 
+ * In cascaded mode the power is a fraction of top speed for the motors'
+ * internal velocity loop instead of a percent of voltage.
+ * 
+ * @param front 
+ * @param back 
+ * @param power 
+ */
+void setSidePower(pros::Motor &front, pros::Motor &back, int power)
 {
-    if (speed < rightSideSpeed)
+    if (cascaded)
     {
-        rightSideSpeed--;
-        right(rightSideSpeed);
+        int rpm = power * driveMaxRPM() / 127;
+        front.move_velocity(rpm);
+        back.move_velocity(rpm);
     }
     else
     {
-        right(speed);
+        front.move(power);
+        back.move(power);
     }
-    wait(accelStep);
 }
 
-void Drive::slewLeftBack(int speed, int accelStep)
+/**
+ * @brief Set left side power through the slew rate limiter
+ * 
+ * Each call moves the power one slew step toward l, so call it every
+ * control step; a single call only starts the ramp (see timedDrive()).
+ * 
+ * @param l 
+ */
+void Drive::left(int l)
 {
-    if (speed < leftSideSpeed)
+    setSidePower(leftFront, leftBack, leftSlew.step(l));
+}
+
+/**
+ * @brief Set right side power through the slew rate limiter (see left())
+ * 
+ * @param r 
+ */
+void Drive::right(int r)
+{
+    setSidePower(rightFront, rightBack, rightSlew.step(r));
+}
+
+/**
+ * @brief Set the speed up limit to one power unit per accelStep milliseconds
+ * 
+ * @param speed 
+ * @param accelStep 
+ */
+void Drive::slewRight(int speed, int accelStep)
+{
+    if (accelStep > 0)
     {
-        leftSideSpeed--;
-        left(leftSideSpeed);
+        rightSlew.setMaxRise(1000.0 / accelStep);
     }
-    else
+    right(speed);
+    rightSlew.resetLimitsToDefaults();
+}
+
+void Drive::slewLeft(int speed, int accelStep)
+{
+    if (accelStep > 0)
     {
-        left(speed);
+        leftSlew.setMaxRise(1000.0 / accelStep);
     }
-    wait(accelStep);
+    left(speed);
+    leftSlew.resetLimitsToDefaults();
 }
 
+void Drive::slewRightBack(int speed, int accelStep)
+{
+    slewRight(speed, accelStep);
+}
+
+void Drive::slewLeftBack(int speed, int accelStep)
+{
+    slewLeft(speed, accelStep);
+}
+
+/**
+ * @brief Set both sides' power through the slew rate limiters
+ * 
+ * drivePower(0, 0) is the stop command, so it is applied immediately and
+ * can't leave the motors running at a partially slewed power. Any other
+ * power, including 0 on one side, is slew limited like left() and right(),
+ * so one call only takes the first step toward it.
+ * 
+ * @param l 
+ * @param r 
+ */
 void Drive::drivePower(int l, int r)
 {
-    leftFront.move(l);
-    leftBack.move(l);
-    rightFront.move(r);
-    rightBack.move(r);
+    if (l == 0 && r == 0)
+    {
+        leftSlew.reset(0);
+        rightSlew.reset(0);
+    }
+    left(l);
+    right(r);
+}
+
+/**
+ * @brief Set the slew rate limiters to the drive's measured speed
+ * 
+ * Used at the start of a movement so it continues from the speed the
+ * previous (fluid) movement left the robot at instead of from 0.
+ */
+void Drive::matchSlewToVelocity()
+{
+    double maxRPM = driveMaxRPM();
+
+    double l_actual = (leftFront.get_actual_velocity() + leftBack.get_actual_velocity()) / 2;
+    double r_actual = (rightFront.get_actual_velocity() + rightBack.get_actual_velocity()) / 2;
+
+    leftSlew.reset(l_actual * 127 / maxRPM);
+    rightSlew.reset(r_actual * 127 / maxRPM);
+}
+
+/**
+ * @brief Raise a movement's speed to at least the exit speed (keeps the sign)
+ * 
+ * @param speed 
+ * @return double 
+ */
+double Drive::applyExitSpeed(double speed)
+{
+    if (speed < 0)
+    {
+        return fmin(speed, -exitSpeed);
+    }
+    return fmax(speed, exitSpeed);
+}
+
+/**
+ * @brief Drive each side at a voltage in millivolts (-12000 to 12000)
+ * 
+ * @param l 
+ * @param r 
+ */
+void Drive::driveVoltage(int l, int r)
+{
+    //Limit in motor power units (-127 to 127) so both output modes share the limiters
+    int l_voltage = leftSlew.step(l * 127.0 / 12000) * 12000 / 127;
+    int r_voltage = rightSlew.step(r * 127.0 / 12000) * 12000 / 127;
+
+    leftFront.move_voltage(l_voltage);
+    leftBack.move_voltage(l_voltage);
+    rightFront.move_voltage(r_voltage);
+    rightBack.move_voltage(r_voltage);
+}
+
+/**
+ * @brief Drive each side at a wheel velocity in inches per second
+ * 
+ * Voltage comes from the drivetrain feedforward, corrected by the velocity
+ * PIDControllers using the motors' measured velocity.
+ * 
+ * @param l 
+ * @param r 
+ * @param lAccel 
+ * @param rAccel 
+ */
+void Drive::driveVelocity(double l, double r, double lAccel, double rAccel)
+{
+    //inches per second -> wheel RPM -> motor RPM
+    double l_rpm = l * 60 / (DRIVE_WHEEL_DIAMETER * PI) / DRIVE_GEAR_RATIO;
+    double r_rpm = r * 60 / (DRIVE_WHEEL_DIAMETER * PI) / DRIVE_GEAR_RATIO;
+
+    double l_actual = (leftFront.get_actual_velocity() + leftBack.get_actual_velocity()) / 2;
+    double r_actual = (rightFront.get_actual_velocity() + rightBack.get_actual_velocity()) / 2;
+
+    double l_voltage = driveFeedforward.getOutput(l, lAccel) + leftVelocityPID.getOutput(l_rpm, l_actual);
+    double r_voltage = driveFeedforward.getOutput(r, rAccel) + rightVelocityPID.getOutput(r_rpm, r_actual);
+
+    driveVoltage(fmax(-12000, fmin(12000, l_voltage)), fmax(-12000, fmin(12000, r_voltage)));
 }
 
+/**
+ * @brief Drive at l and r power for time ms, then stop
+ * 
+ * The power is sent every MOTION_PERIOD so the slew rate limiters ramp up
+ * to it instead of holding their first step.
+ * 
+ * @param time 
+ * @param l 
+ * @param r 
+ */
 void Drive::timedDrive(int time, int l, int r)
 {
-    drivePower(l, r);
-    wait(time);
+    std::uint32_t start = pros::millis();
+    std::uint32_t now = start;
+    while ((int)(now - start) < time)
+    {
+        drivePower(l, r);
+        pros::Task::delay_until(&now, MOTION_PERIOD);
+    }
     drivePower(0, 0);
 }
 
@@ -229,94 +848,391 @@ void Drive::driveOP()
     right(master.get_analog(ANALOG_RIGHT_Y));
     left(master.get_analog(ANALOG_LEFT_Y));
 }
-/*******************************************************************/
+/*******************************************************************/
+
+/**
+ * @brief Helper method that maintains the drive's target heading
+ * 
+ * headingPID's output is added to the left side and subtracted from the
+ * right side. If that would saturate a side, the forward speed is reduced
+ * instead so the full correction is kept.
+ * 
+ * @param heading 
+ * @param correctionMultiplier scales the heading correction (1 = headingPID as tuned)
+ * @param PIDSpeed signed forward speed (the slew limiters set the acceleration)
+ */
+void Drive::moveHeadingCorrection(double heading, double correctionMultiplier, double PIDSpeed)
+{
+    PIDSpeed = applyExitSpeed(PIDSpeed);
+
+    //Positive when the robot needs to turn clockwise, whichever way it is driving
+    double correction = headingPID.getOutput(heading, getTheta()) * correctionMultiplier;
+    correction = fmax(-127, fmin(127, correction));
+
+    double headroom = 127 - fabs(correction);
+    PIDSpeed = fmax(-headroom, fmin(headroom, PIDSpeed));
+
+    left(PIDSpeed + correction);
+    right(PIDSpeed - correction);
+}
+
+/**
+ * @brief Temporarily scale the heading correction on any movement in moveTask()
+ * 
+ * @param cM 
+ * @return Drive& 
+ */
+Drive &Drive::withCorrection(double cM)
+{
+    nextCommand.correctionMultiplier = cM;
+
+    return *this;
+}
+
+/**
+ * @brief Call a function during the next movement once a condition is met
+ * 
+ * TYPES:
+ * - MARKER_DISTANCE_TRAVELED: value is inches driven since the start
+ * - MARKER_DISTANCE_REMAINING: value is inches (degrees for turns) left
+ * - MARKER_TIME_ELAPSED: value is milliseconds since the start
+ * - MARKER_HEADING: value is a heading (degrees) the robot turns across
+ * 
+ * Up to MAX_MARKERS markers can be attached to one movement, and a null
+ * callback is ignored. Callbacks run on the drive task, so they must not
+ * start or wait for movements.
+ * 
+ * @param type 
+ * @param value 
+ * @param callback 
+ * @return Drive& 
+ */
+Drive &Drive::withMarker(int type, double value, void (*callback)())
+{
+    if (callback == nullptr)
+    {
+        printf("Marker ignored: no callback\n");
+        return *this;
+    }
+    if (nextCommand.markerCount < MAX_MARKERS)
+    {
+        nextCommand.markers[nextCommand.markerCount++] = {type, value, 0, 0, 0, callback, false};
+    }
+
+    return *this;
+}
+
+/**
+ * @brief Call a function during the next movement once the robot enters a region
+ * 
+ * @param x1 
+ * @param y1 
+ * @param x2 
+ * @param y2 
+ * @param callback 
+ * @return Drive& 
+ */
+Drive &Drive::withRegionMarker(double x1, double y1, double x2, double y2, void (*callback)())
+{
+    if (callback == nullptr)
+    {
+        printf("Marker ignored: no callback\n");
+        return *this;
+    }
+    if (nextCommand.markerCount < MAX_MARKERS)
+    {
+        nextCommand.markers[nextCommand.markerCount++] = {MARKER_IN_REGION, x1, y1, x2, y2, callback, false};
+    }
+
+    return *this;
+}
+
+/**
+ * @brief Abort the next movement if it takes longer than timeout ms
+ * 
+ * @param timeout 
+ * @return Drive& 
+ */
+Drive &Drive::withTimeout(int timeout)
+{
+    nextCommand.timeout = timeout;
+
+    return *this;
+}
+
+/**
+ * @brief Choose turnMPC or turnPID for the next point turn (see USE_MPC_TURNS)
+ * 
+ * @param enabled 
+ * @return Drive& 
+ */
+Drive &Drive::withMPC(bool enabled)
+{
+    nextCommand.mpc = enabled;
+
+    return *this;
+}
+
+/**
+ * @brief Choose the output mode for the next movement (see CASCADED_CONTROL)
+ * 
+ * @param enabled true to hold motor velocity targets, false for percent power
+ * @return Drive& 
+ */
+Drive &Drive::withCascade(bool enabled)
+{
+    nextCommand.cascade = enabled;
+
+    return *this;
+}
+
+/**
+ * @brief Use a different settle detector for the next movement
+ * 
+ * @param settle 
+ * @return Drive& 
+ */
+Drive &Drive::withSettle(SettleDetector &settle)
+{
+    nextCommand.settle = &settle;
+
+    return *this;
+}
+
+/**
+ * @brief Start timing a movement; returns its (reset) settle detector
+ * 
+ * @param defaultSettle detector used if withSettle() wasn't called
+ * @return SettleDetector& 
+ */
+SettleDetector &Drive::startMotion(SettleDetector &defaultSettle)
+{
+    activeSettle = activeCommand.settle != nullptr ? activeCommand.settle : &defaultSettle;
+    activeSettle->reset();
+    headingPID.reset();
+    poseSteerPID.reset();
+    turnPID.reset();
+
+    activeTimeout = activeCommand.timeout;
+    cascaded = activeCommand.cascade == -1 ? CASCADED_CONTROL : activeCommand.cascade;
+    stalling = false;
+    exitReason = MOTION_COMPLETE;
+    motionStartTime = pros::millis();
+
+    //Markers are copied so the fired flags start clear for each movement
+    for (int i = 0; i < activeCommand.markerCount; i++)
+    {
+        activeMarkers[i] = activeCommand.markers[i];
+        if (activeMarkers[i].type == MARKER_HEADING)
+        {
+            //Remember which side of the threshold the heading started on
+            activeMarkers[i].c = getTheta() >= activeMarkers[i].a;
+        }
+    }
+    activeMarkerCount = activeCommand.markerCount;
+    distanceTraveled = 0;
+    prevMarkerX = getX();
+    prevMarkerY = getY();
+
+    return *activeSettle;
+}
+
+/**
+ * @brief Runs the per-step checks shared by every movement
+ * 
+ * Call once per control step. Fires any event markers that are due and
+ * checks for a timeout or a stall, recording why the movement should stop
+ * (see getExitReason()).
+ * 
+ * @param remaining distance left in the movement (inches, or degrees for turns)
+ * @return true if the movement should be aborted
+ */
+bool Drive::controlStep(double remaining)
+{
+    //A newer command, cancel() or a competition mode change stops this movement
+    if (!motionQueue.empty() || activeCommand.sequence <= cancelledSequence ||
+        activeCommand.status != pros::competition::get_status())
+    {
+        exitReason = MOTION_CANCELLED;
+        return true;
+    }
+
+    dispatchMarkers(remaining);
+
+    std::uint32_t now = pros::millis();
+    int elapsed = now - motionStartTime;
+
+    if (activeTimeout > 0 && elapsed >= activeTimeout)
+    {
+        exitReason = MOTION_TIMEOUT;
+        return true;
+    }
+
+    if (elapsed < STALL_IGNORE_TIME)
+    {
+        return false;
+    }
+
+    double current = (leftFront.get_current_draw() + leftBack.get_current_draw() +
+                      rightFront.get_current_draw() + rightBack.get_current_draw()) /
+                     4.0;
+    double rpm = (fabs(leftFront.get_actual_velocity()) + fabs(leftBack.get_actual_velocity()) +
+                  fabs(rightFront.get_actual_velocity()) + fabs(rightBack.get_actual_velocity())) /
+                 4.0;
+    bool stalled = current > STALL_CURRENT && rpm < STALL_RPM && getVelocity() < 1 && fabs(getAngularVelocity()) < 10;
+
+    if (stalled && !stalling)
+    {
+        stallStartTime = now;
+    }
+    stalling = stalled;
+
+    if (stalling && (int)(now - stallStartTime) >= STALL_TIME)
+    {
+        exitReason = MOTION_STALLED;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Fires the current movement's markers whose condition has been met
+ * 
+ * Each marker fires at most once. Callbacks run inside the control loop,
+ * so they must return quickly (ex. start a motor, set a flag).
+ * 
+ * @param remaining 
+ */
+void Drive::dispatchMarkers(double remaining)
+{
+    if (activeMarkerCount == 0)
+    {
+        return;
+    }
+
+    distanceTraveled += hypot(getX() - prevMarkerX, getY() - prevMarkerY);
+    prevMarkerX = getX();
+    prevMarkerY = getY();
+    int elapsed = pros::millis() - motionStartTime;
+
+    for (int i = 0; i < activeMarkerCount; i++)
+    {
+        MotionMarker &marker = activeMarkers[i];
+        if (marker.fired)
+        {
+            continue;
+        }
+
+        bool due = false;
+        switch (marker.type)
+        {
+        case MARKER_DISTANCE_TRAVELED:
+            due = distanceTraveled >= marker.a;
+            break;
+        case MARKER_DISTANCE_REMAINING:
+            due = remaining <= marker.a;
+            break;
+        case MARKER_TIME_ELAPSED:
+            due = elapsed >= marker.a;
+            break;
+        case MARKER_IN_REGION:
+            due = getX() >= fmin(marker.a, marker.c) && getX() <= fmax(marker.a, marker.c) &&
+                  getY() >= fmin(marker.b, marker.d) && getY() <= fmax(marker.b, marker.d);
+            break;
+        case MARKER_HEADING:
+            due = (getTheta() >= marker.a) != (marker.c != 0);
+            break;
+        }
+
+        if (due)
+        {
+            marker.fired = true;
+            marker.callback();
+        }
+    }
+}
 
 /**
- * @brief Helper method that maintains the drive's target heading
+ * @brief Record and print how the finished movement ended
  * 
- * @param heading 
- * @param correctionMultiplier 
- * @param PIDSpeed 
- * @param accelStep 
- * @param backward 
+ * An aborted or cancelled movement always stops the drive, even if it was
+ * fluid. The movement is added to motionMetrics with its response (if
+ * given), settle time and exit reason.
+ * 
+ * @param response the controller's response over the movement (or nullptr)
  */
-void Drive::moveHeadingCorrection(int heading, double correctionMultiplier, double PIDSpeed, int accelStep, bool backward)
+void Drive::finishMotion(ResponseMetrics *response)
 {
-    if (backward == false)
+    if (exitReason != MOTION_COMPLETE)
     {
-        if ((heading - getTheta() >= 3 || heading - getTheta() <= -3))
-        {
-            if (getTheta() < heading)
-            {
-                left(PIDSpeed);
-                right(correctionMultiplier * PIDSpeed);
-            }
-            if (getTheta() > heading)
-            {
-                left(correctionMultiplier * PIDSpeed);
-                right(PIDSpeed);
-            }
-        }
-        else
-        {
-            if (getTheta() < heading)
-            {
-                left(PIDSpeed);
-                right(PIDSpeed * 0.6);
-            }
-            if (getTheta() > heading)
-            {
-                left(PIDSpeed * 0.6);
-                right(PIDSpeed);
-            }
-        }
+        drivePower(0, 0);
     }
-    else if (backward)
+
+    int motionTime = pros::millis() - motionStartTime;
+    lastSettleTime = activeSettle != nullptr ? activeSettle->getSettleTime() : -1;
+
+    if (exitReason == MOTION_TIMEOUT)
     {
-        if ((heading - getTheta() >= 5 || heading - getTheta() <= -5))
-        {
-            if (getTheta() < heading)
-            {
-                left(correctionMultiplier * PIDSpeed);
-                right(PIDSpeed);
-            }
-            if (getTheta() > heading)
-            {
-                left(PIDSpeed);
-                right(correctionMultiplier * PIDSpeed);
-            }
-        }
-        else
-        {
-            if (getTheta() < heading)
-            {
-                left(PIDSpeed * 0.6);
-                right(PIDSpeed);
-            }
-            if (getTheta() > heading)
-            {
-                left(PIDSpeed);
-                right(PIDSpeed * 0.6);
-            }
-        }
+        printf("Motion timed out after %d ms\n", motionTime);
+    }
+    else if (exitReason == MOTION_STALLED)
+    {
+        printf("Motion stalled after %d ms\n", motionTime);
+    }
+    else if (exitReason == MOTION_CANCELLED)
+    {
+        printf("Motion cancelled after %d ms\n", motionTime);
     }
+    else
+    {
+        printf("Motion finished in %d ms (settled at %d ms)\n", motionTime, lastSettleTime);
+    }
+
+    MetricsRecord record = {motionName, -1, 0, 0, lastSettleTime, 0, motionTime, exitReason};
+    if (response != nullptr)
+    {
+        record.riseTime = response->riseTime;
+        record.overshoot = response->overshoot;
+        record.integralAbsoluteError = response->integralAbsoluteError;
+        record.finalError = response->finalError;
+    }
+    motionMetrics.add(record);
+
+    //Anything sent outside a movement (ex. driver control) is percent power
+    cascaded = false;
+}
+
+//Feedback: why the last movement ended (MOTION_COMPLETE, MOTION_TIMEOUT, MOTION_STALLED or MOTION_CANCELLED)
+int Drive::getExitReason()
+{
+    return exitReason;
+}
+
+//Feedback: settle time (ms) of the last movement, -1 if it exited without settling
+int Drive::getSettleTime()
+{
+    return lastSettleTime;
 }
 
 /**
- * @brief Temporarily change correctionMultiplier on any movement in moveTask()
+ * @brief Hold at least this speed through the end of the next movement
  * 
- * @param cM 
+ * Use with fluid movements so the robot carries its speed into the next
+ * movement instead of slowing down at every boundary. Ignored by point
+ * turns and sweeps without a threshold, which have to settle.
+ * 
+ * @param speed 
  * @return Drive& 
  */
-Drive &Drive::withCorrection(double cM)
+Drive &Drive::withExitSpeed(int speed)
 {
-    correctionMultiplier = cM;
+    nextCommand.exitSpeed = abs(speed);
 
     return *this;
 }
 
 /**
- * @brief Temporarily change the gains on any movement in moveTask()
+ * @brief Change movePID's gains for the next movement
  * 
  * @param kP 
  * @param kI 
@@ -326,12 +1242,12 @@ Drive &Drive::withCorrection(double cM)
  */
 Drive &Drive::withGains(double kP, double kI, double kD, int minSpeed)
 {
-    movePID.setGains(kP, kI, kD, minSpeed);
+    nextCommand.moveGains = {true, kP, kI, kD, minSpeed};
     return *this;
 }
 
 /**
- * @brief Temporarily change the gains on any turn in turnTask()
+ * @brief Change turnPID's gains for the next turn
  * 
  * @param kP 
  * @param kI 
@@ -341,10 +1257,76 @@ Drive &Drive::withGains(double kP, double kI, double kD, int minSpeed)
  */
 Drive &Drive::withTurnGains(double kP, double kI, double kD, int minSpeed)
 {
-    turnPID.setGains(kP, kI, kD, minSpeed);
+    nextCommand.turnGains = {true, kP, kI, kD, minSpeed};
     return *this;
 }
 
+/**
+ * @brief Use a gain profile from the SD card for the next movement (see gainProfiles.hpp)
+ * 
+ * The movement keeps its default gains if there is no profile with that id.
+ * 
+ * @param id 
+ * @return Drive& 
+ */
+Drive &Drive::withGainProfile(int id)
+{
+    const GainProfile *profile = gainProfiles.get(id);
+    if (profile == nullptr)
+    {
+        printf("No gain profile %d\n", id);
+        return *this;
+    }
+    return withGains(profile->kP, profile->kI, profile->kD, profile->minSpeed);
+}
+
+/**
+ * @brief Use a gain profile from the SD card for the next turn (see gainProfiles.hpp)
+ * 
+ * @param id 
+ * @return Drive& 
+ */
+Drive &Drive::withTurnGainProfile(int id)
+{
+    const GainProfile *profile = gainProfiles.get(id);
+    if (profile == nullptr)
+    {
+        printf("No gain profile %d\n", id);
+        return *this;
+    }
+    return withTurnGains(profile->kP, profile->kI, profile->kD, profile->minSpeed);
+}
+
+//Single-row tables that replace the gain schedules once gains are tuned
+GainPoint tunedCoordinateGains;
+GainPoint tunedDistanceGains;
+GainPoint tunedTurnGains;
+
+/**
+ * @brief Use tuned gains (power per inch) for every move instead of the schedules
+ * 
+ * Distance moves measure encoder ticks, so their gains are converted.
+ * 
+ * @param gains
+ */
+void Drive::setTunedMoveGains(GainPoint gains)
+{
+    double inchesPerTick = WHEEL_DIAMETER * PI / TICS_PER_REVOLUTION;
+    tunedCoordinateGains = gains;
+    tunedDistanceGains = {gains.magnitude, gains.kP * inchesPerTick, gains.kI * inchesPerTick, gains.kD * inchesPerTick, gains.minSpeed};
+
+    moveCoordinateSchedule.setTable(&tunedCoordinateGains, 1);
+    moveBackXSchedule.setTable(&tunedCoordinateGains, 1);
+    moveDistanceSchedule.setTable(&tunedDistanceGains, 1);
+}
+
+//Use tuned gains (power per degree) for point turns instead of the schedule
+void Drive::setTunedTurnGains(GainPoint gains)
+{
+    tunedTurnGains = gains;
+    turnSchedule.setTable(&tunedTurnGains, 1);
+}
+
 /**
  * @brief drive for distance in inches
  * 
@@ -357,27 +1339,7 @@ Drive &Drive::withTurnGains(double kP, double kI, double kD, int minSpeed)
  */
 Drive &Drive::move(int distance, int heading, int accelStep, bool async, bool fluid)
 {
-    if (!moveComplete)
-    {
-        moveStopTask();
-    }
-    if (move_task != nullptr)
-    {
-        move_task = nullptr;
-    }
-    //set move targets
-    moveTargets = {distance, heading, accelStep, fluid, MOVE_FOR_DISTANCE};
-    moveComplete = false;
-    if (async)
-    {
-        //call as task
-        moveStartTask();
-    }
-    else
-    {
-        //call as method (syncronous)
-        moveTask(nullptr);
-    }
+    startMove({distance, heading, accelStep, fluid, MOVE_FOR_DISTANCE}, async);
 
     return *this;
 }
@@ -394,25 +1356,7 @@ Drive &Drive::move(int distance, int heading, int accelStep, bool async, bool fl
  */
 Drive &Drive::moveToYCoord(int distance, int heading, int accelStep, bool async, bool fluid)
 {
-    if (!moveComplete)
-    {
-        moveStopTask();
-    }
-    if (move_task != nullptr)
-    {
-        move_task = nullptr;
-    }
-    //set move targets
-    moveTargets = {distance, heading, accelStep, fluid, MOVE_TO_Y_COORD};
-    moveComplete = false;
-    if (async)
-    {
-        moveStartTask();
-    }
-    else
-    {
-        moveTask(nullptr);
-    }
+    startMove({distance, heading, accelStep, fluid, MOVE_TO_Y_COORD}, async);
 
     return *this;
 }
@@ -429,25 +1373,7 @@ Drive &Drive::moveToYCoord(int distance, int heading, int accelStep, bool async,
  */
 Drive &Drive::moveToXCoord(int distance, int heading, int accelStep, bool async, bool fluid)
 {
-    if (!moveComplete)
-    {
-        moveStopTask();
-    }
-    if (move_task != nullptr)
-    {
-        move_task = nullptr;
-    }
-    //set move targets
-    moveTargets = {distance, heading, accelStep, fluid, MOVE_TO_X_COORD};
-    moveComplete = false;
-    if (async)
-    {
-        moveStartTask();
-    }
-    else
-    {
-        moveTask(nullptr);
-    }
+    startMove({distance, heading, accelStep, fluid, MOVE_TO_X_COORD}, async);
 
     return *this;
 }
@@ -464,25 +1390,7 @@ Drive &Drive::moveToXCoord(int distance, int heading, int accelStep, bool async,
  */
 Drive &Drive::moveBackToYCoord(int distance, int heading, int accelStep, bool async, bool fluid)
 {
-    if (!moveComplete)
-    {
-        moveStopTask();
-    }
-    if (move_task != nullptr)
-    {
-        move_task = nullptr;
-    }
-    //set move targets
-    moveTargets = {distance, heading, accelStep, fluid, MOVE_BACK_TO_Y_COORD};
-    moveComplete = false;
-    if (async)
-    {
-        moveStartTask();
-    }
-    else
-    {
-        moveTask(nullptr);
-    }
+    startMove({distance, heading, accelStep, fluid, MOVE_BACK_TO_Y_COORD}, async);
 
     return *this;
 }
@@ -499,254 +1407,580 @@ Drive &Drive::moveBackToYCoord(int distance, int heading, int accelStep, bool as
  */
 Drive &Drive::moveBackToXCoord(int distance, int heading, int accelStep, bool async, bool fluid)
 {
-    if (!moveComplete)
+    startMove({distance, heading, accelStep, fluid, MOVE_BACK_TO_X_COORD}, async);
+
+    return *this;
+}
+
+/**
+ * @brief move to a point (x, y), turning toward it while driving
+ * 
+ * Slows down as the distance to the point shrinks and finishes once the
+ * robot passes the point along the line from where it started.
+ * 
+ * @param x 
+ * @param y 
+ * @param backward drive to the point in reverse
+ * @param async 
+ * @param fluid 
+ * @return Drive& 
+ */
+Drive &Drive::moveToPoint(int x, int y, bool backward, bool async, bool fluid)
+{
+    //targetDistance only carries the direction (negative drives backward)
+    MoveTargets targets = {backward ? -1 : 1, 0, 0, fluid, MOVE_TO_POINT};
+    targets.targetX = x;
+    targets.targetY = y;
+    startMove(targets, async);
+
+    return *this;
+}
+
+/**
+ * @brief move to a pose (x, y, theta) in one continuous motion
+ * 
+ * Drives toward a carrot point placed behind the target along the final
+ * heading. The carrot converges onto the target as the robot approaches,
+ * so the robot arrives facing theta without stopping to turn.
+ * 
+ * @param x 
+ * @param y 
+ * @param theta 
+ * @param async 
+ * @param fluid 
+ * @return Drive& 
+ */
+Drive &Drive::moveToPose(int x, int y, int theta, bool async, bool fluid)
+{
+    MoveTargets targets = {0, theta, 0, fluid, MOVE_TO_POSE};
+    targets.targetX = x;
+    targets.targetY = y;
+    startMove(targets, async);
+
+    return *this;
+}
+
+//******************************************************************************
+//****************************Motion Engine*************************************
+
+/*
+ * Every move, turn and sweep runs through runMotion(), specialized at compile
+ * time by three policies:
+ * 
+ * Measure: what is being controlled
+ *     get()          current value in the PID's units
+ *     normalize(e)   converts an error to inches (moves) or degrees (turns)
+ * Output: how the PID output is sent to the drive
+ *     apply(speed)
+ * Exit: when the movement is finished
+ *     done(error, side, threshold, settle)
+ *     side is +1 if the target started above the measurement, otherwise -1
+ *     holdsExitSpeed   false if the movement has to settle, so withExitSpeed() is ignored
+ */
+
+//Left tracking wheel in encoder ticks (move() gains are tuned in ticks)
+struct EncoderTicks
+{
+    static double get() { return L.get_value(); }
+    static double normalize(double error) { return error * WHEEL_DIAMETER * PI / TICS_PER_REVOLUTION; }
+};
+
+struct XPosition
+{
+    static double get() { return getX(); }
+    static double normalize(double error) { return error; }
+};
+
+struct YPosition
+{
+    static double get() { return getY(); }
+    static double normalize(double error) { return error; }
+};
+
+struct Heading
+{
+    static double get() { return getTheta(); }
+    static double normalize(double error) { return error; }
+};
+
+//Distance (inches) from a moveToPose target where the robot stops steering to the carrot
+const double POSE_CLOSE_RANGE = 3;
+
+//Negative straight-line distance left to the moveToPose target (target is 0)
+struct PoseProgress
+{
+    static double get() { return -hypot(moveTargets.targetX - getX(), moveTargets.targetY - getY()); }
+    static double normalize(double error) { return error; }
+};
+
+//Negative distance left to the moveToPoint target, projected onto the start-to-target line (target is 0)
+double pointDirectionX = 1;
+double pointDirectionY = 0;
+
+struct PointProgress
+{
+    static double get()
     {
-        moveStopTask();
+        double dx = moveTargets.targetX - getX();
+        double dy = moveTargets.targetY - getY();
+        return -(dx * pointDirectionX + dy * pointDirectionY);
     }
-    if (move_task != nullptr)
+    static double normalize(double error) { return error; }
+};
+
+//Drive straight at the target heading; Direction is 1 (forward) or -1 (backward)
+template <int Direction>
+struct StraightOutput
+{
+    static void apply(double speed)
     {
-        move_task = nullptr;
+        Drive::moveHeadingCorrection(moveTargets.targetHeading, correctionMultiplier, Direction * fabs(speed));
     }
-    //set move targets
-    moveTargets = {distance, heading, accelStep, fluid, MOVE_BACK_TO_X_COORD};
-    moveComplete = false;
-    if (async)
+};
+
+struct PointTurnOutput
+{
+    static void apply(double speed)
     {
-        moveStartTask();
+        speed = Drive::applyExitSpeed(speed);
+        Drive::drivePower(speed, -speed);
     }
-    else
+};
+
+//PID drives the left side, right side holds its sweep speed
+struct LeftSideOutput
+{
+    static void apply(double speed)
     {
-        moveTask(nullptr);
+        Drive::drivePower(Drive::applyExitSpeed(speed), turnTargets.rightSideSpeed);
     }
+};
 
-    return *this;
-}
-
-void Drive::moveTask(void *parameter)
+//PID drives the right side, left side holds its sweep speed
+struct RightSideOutput
 {
-    switch (moveTargets.moveType)
-    {
-    case MOVE_FOR_DISTANCE:
+    static void apply(double speed)
     {
-        if (moveTargets.fluid && movePID.gainsAreAtDefaults())
-        {
-            movePID.setGains(0.15, 0, 0, 75);
-        }
+        Drive::drivePower(turnTargets.leftSideSpeed, -Drive::applyExitSpeed(speed));
+    }
+};
 
-        if (moveTargets.targetDistance < 0)
-        {
-            //Calculate target in inches
-            double target = (L.get_value()) - TICS_PER_REVOLUTION * (abs(moveTargets.targetDistance) / (WHEEL_DIAMETER * PI));
+//Aim the front (or back if Direction is -1) at the moveToPoint target while driving
+template <int Direction>
+struct PointOutput
+{
+    static void apply(double speed)
+    {
+        double dx = moveTargets.targetX - getX();
+        double dy = moveTargets.targetY - getY();
 
-            while (L.get_value() > target)
-            {
-                double PIDSpeed = (movePID.getOutput(target, L.get_value()));
-                //Move straight at heading
-                moveHeadingCorrection(moveTargets.targetHeading, correctionMultiplier, PIDSpeed, moveTargets.accelStep, true);
-            }
-        }
-        else
+        //Within a few inches the angle to the target swings wildly, so keep the current heading
+        double headingError = 0;
+        if (sqrt(dx * dx + dy * dy) > 3)
         {
-            double target = (L.get_value()) + TICS_PER_REVOLUTION * (abs(moveTargets.targetDistance) / (WHEEL_DIAMETER * PI));
-
-            while (L.get_value() < target)
+            double angleToTarget = atan2(-dy, dx) * 180 / PI;
+            if (Direction < 0)
             {
-                double PIDSpeed = movePID.getOutput(target, L.get_value());
-                moveHeadingCorrection(moveTargets.targetHeading, correctionMultiplier, PIDSpeed, moveTargets.accelStep, false);
+                angleToTarget += 180;
             }
+            headingError = wrapAngle(angleToTarget - getTheta());
         }
 
-        if (!moveTargets.fluid)
-        {
-            drivePower(0, 0);
-        }
+        //Slow down while the robot isn't facing the target
+        speed = fabs(speed) * fmax(0, cos(headingError * PI / 180));
 
-        //set all modifiers back to defaults
-        leftSideSpeed = 0;
-        rightSideSpeed = 0;
-        correctionMultiplier = 0.2;
-        movePID.resetGainsToDefaults();
-        moveComplete = true;
-        moveStopTask();
-        break;
+        Drive::moveHeadingCorrection(getTheta() + headingError, correctionMultiplier, Direction * speed);
     }
-    case MOVE_TO_X_COORD:
-    {
-        if (moveTargets.fluid && movePID.gainsAreAtDefaults())
+};
+
+//Steer toward a carrot point behind the target that converges onto it
+struct PoseOutput
+{
+    static void apply(double speed)
+    {
+        //How far behind the target the carrot starts (0-1)
+        const double lead = 0.6;
+        double targetHeading = moveTargets.targetHeading * PI / 180;
+        double dx = moveTargets.targetX - getX();
+        double dy = moveTargets.targetY - getY();
+        double distance = sqrt(dx * dx + dy * dy);
+
+        double angleError;
+        double linearSpeed;
+        if (distance > POSE_CLOSE_RANGE)
         {
-            movePID.setGains(6, 0, 0, 75);
+            double carrotX = moveTargets.targetX - lead * distance * cos(targetHeading);
+            double carrotY = moveTargets.targetY + lead * distance * sin(targetHeading);
+            double angleToCarrot = atan2(-(carrotY - getY()), carrotX - getX()) * 180 / PI;
+
+            angleError = wrapAngle(angleToCarrot - getTheta());
+            linearSpeed = speed * cos(angleError * PI / 180);
         }
-        else if (movePID.gainsAreAtDefaults())
+        else
         {
-            movePID.setGains(6, 0, 0, 30);
+            //Close to the target: hold the final heading and finish the approach
+            angleError = wrapAngle(moveTargets.targetHeading - getTheta());
+            linearSpeed = speed;
         }
+        linearSpeed = Drive::applyExitSpeed(linearSpeed);
+        double angularSpeed = poseSteerPID.getOutput(angleError);
 
-        double target = moveTargets.targetDistance;
+        double leftSpeed = linearSpeed + angularSpeed;
+        double rightSpeed = linearSpeed - angularSpeed;
 
-        if (getX() < target)
+        //Scale both sides down together so the turning ratio is kept
+        double largest = fmax(fabs(leftSpeed), fabs(rightSpeed));
+        if (largest > 127)
         {
-            while (getX() < target)
-            {
-                double PIDSpeed = (movePID.getOutput(target, getX()));
-                moveHeadingCorrection(moveTargets.targetHeading, correctionMultiplier, PIDSpeed, moveTargets.accelStep, false);
-            }
+            leftSpeed = leftSpeed * 127 / largest;
+            rightSpeed = rightSpeed * 127 / largest;
         }
-        else if (getX() > target)
+        Drive::drivePower(leftSpeed, rightSpeed);
+    }
+};
+
+//Finished once the target is reached or passed (or settled just short of it)
+struct UntilCrossed
+{
+    static constexpr bool holdsExitSpeed = true;
+
+    template <typename Measure>
+    static bool done(double error, double side, double threshold, SettleDetector &settle)
+    {
+        return error * side <= 0 || settle.isSettled(Measure::normalize(error));
+    }
+};
+
+/*
+ * Finished once the moveToPose target is reached or passed along its final
+ * heading (or settled just short of it). Only checked within
+ * POSE_CLOSE_RANGE, so a target that starts behind the robot is driven
+ * around to instead of ending the movement.
+ */
+struct UntilPosePassed
+{
+    static constexpr bool holdsExitSpeed = true;
+
+    template <typename Measure>
+    static bool done(double error, double side, double threshold, SettleDetector &settle)
+    {
+        if (error <= POSE_CLOSE_RANGE)
         {
-            while (getX() > target)
+            double targetHeading = moveTargets.targetHeading * PI / 180;
+            double dx = moveTargets.targetX - getX();
+            double dy = moveTargets.targetY - getY();
+            if (dx * cos(targetHeading) - dy * sin(targetHeading) <= 0)
             {
-                double PIDSpeed = (-movePID.getOutput(target, getX()));
-                moveHeadingCorrection(moveTargets.targetHeading, correctionMultiplier, PIDSpeed, moveTargets.accelStep, false);
+                return true;
             }
         }
-        if (!moveTargets.fluid)
+        return settle.isSettled(Measure::normalize(error));
+    }
+};
+
+struct UntilSettled
+{
+    static constexpr bool holdsExitSpeed = false;
+
+    template <typename Measure>
+    static bool done(double error, double side, double threshold, SettleDetector &settle)
+    {
+        return settle.isSettled(Measure::normalize(error));
+    }
+};
+
+//Finished within threshold of the target; Side is the direction the measurement travels
+template <int Side>
+struct UntilThreshold
+{
+    static constexpr bool holdsExitSpeed = true;
+
+    template <typename Measure>
+    static bool done(double error, double side, double threshold, SettleDetector &settle)
+    {
+        return error * Side <= threshold;
+    }
+};
+
+/**
+ * @brief Fixed-rate control loop shared by every movement
+ * 
+ * @param pid controller for the measured quantity
+ * @param defaultSettle settle detector used if withSettle() wasn't called
+ * @param target 
+ * @param threshold used by UntilThreshold
+ * @param stopAtEnd stop the drive when finished (false for fluid movements)
+ */
+template <typename Measure, typename Output, typename Exit, typename Controller>
+void runMotion(Controller &pid, SettleDetector &defaultSettle, double target, double threshold, bool stopAtEnd)
+{
+    SettleDetector &settle = Drive::startMotion(defaultSettle);
+    pid.reset();
+
+    //A minimum speed near zero error would keep a settled movement from ever settling
+    if (!Exit::holdsExitSpeed)
+    {
+        exitSpeed = 0;
+    }
+    ResponseMetrics response;
+    double side = target >= Measure::get() ? 1 : -1;
+    std::uint32_t now = pros::millis();
+
+    while (true)
+    {
+        std::uint32_t start = pros::micros();
+        double current = Measure::get();
+        double error = target - current;
+        response.update(Measure::normalize(error));
+        if (Exit::template done<Measure>(error, side, threshold, settle) || Drive::controlStep(fabs(Measure::normalize(error))))
         {
-            drivePower(0, 0);
+            break;
         }
 
-        //set all modifiers back to defaults
-        leftSideSpeed = 0;
-        rightSideSpeed = 0;
-        correctionMultiplier = 0.2;
-        movePID.resetGainsToDefaults();
-        moveComplete = true;
-        moveStopTask();
+        Output::apply(pid.getOutput(target, current));
+        Drive::recordControlStep(start, now, MOTION_PERIOD);
+        pros::Task::delay_until(&now, MOTION_PERIOD);
+    }
+    if (stopAtEnd)
+    {
+        Drive::drivePower(0, 0);
+    }
+    Drive::finishMotion(&response);
+}
+
+/**
+ * @brief Schedule movePID's gains for this movement unless withGains() set them
+ * 
+ * @param schedule 
+ * @param magnitude size of the movement in inches
+ * @param fluid fluid movements keep a minSpeed of 75
+ */
+void scheduleMoveGains(GainSchedule &schedule, double magnitude, bool fluid)
+{
+    if (movePID.gainsAreAtDefaults())
+    {
+        schedule.apply(movePID, magnitude, fluid ? 75 : -1);
+    }
+}
+
+void Drive::moveTask(void *parameter)
+{
+    motionName = moveNames[moveTargets.moveType];
 
-        break;
+    //Start from the current speed so chained movements don't re-ramp
+    matchSlewToVelocity();
+
+    //accelStep is the milliseconds per power unit when speeding up
+    if (moveTargets.accelStep > 0)
+    {
+        leftSlew.setMaxRise(1000.0 / moveTargets.accelStep);
+        rightSlew.setMaxRise(1000.0 / moveTargets.accelStep);
     }
-    case MOVE_BACK_TO_X_COORD:
+
+    bool stopAtEnd = !moveTargets.fluid;
+
+    switch (moveTargets.moveType)
     {
-        if (moveTargets.fluid && movePID.gainsAreAtDefaults())
-        {
-            movePID.setGains(6, 0, 0, 75);
-        }
-        else if (movePID.gainsAreAtDefaults())
-        {
-            movePID.setGains(5, 0, 0, 30);
-        }
+    case MOVE_FOR_DISTANCE:
+    {
+        scheduleMoveGains(moveDistanceSchedule, moveTargets.targetDistance, moveTargets.fluid);
 
-        double target = moveTargets.targetDistance;
+        //Calculate target in encoder ticks
+        double ticks = TICS_PER_REVOLUTION * (abs(moveTargets.targetDistance) / (WHEEL_DIAMETER * PI));
 
-        if (getX() < target)
-        {
-            while (getX() < target)
-            {
-                double PIDSpeed = (-movePID.getOutput(target, getX()));
-                moveHeadingCorrection(moveTargets.targetHeading, correctionMultiplier, PIDSpeed, moveTargets.accelStep, true);
-            }
-        }
-        else if (getX() > target)
+        if (moveTargets.targetDistance < 0)
         {
-            while (getX() > target)
-            {
-                double PIDSpeed = (movePID.getOutput(target, getX()));
-                moveHeadingCorrection(moveTargets.targetHeading, correctionMultiplier, PIDSpeed, moveTargets.accelStep, true);
-            }
+            runMotion<EncoderTicks, StraightOutput<-1>, UntilCrossed>(movePID, moveSettle, L.get_value() - ticks, 0, stopAtEnd);
         }
-        if (!moveTargets.fluid)
+        else
         {
-            drivePower(0, 0);
+            runMotion<EncoderTicks, StraightOutput<1>, UntilCrossed>(movePID, moveSettle, L.get_value() + ticks, 0, stopAtEnd);
         }
-
-        //set all modifiers back to defaults
-        leftSideSpeed = 0;
-        rightSideSpeed = 0;
-        correctionMultiplier = 0.2;
-        movePID.resetGainsToDefaults();
-        moveComplete = true;
-        moveStopTask();
-
+        break;
+    }
+    case MOVE_TO_X_COORD:
+    {
+        scheduleMoveGains(moveCoordinateSchedule, moveTargets.targetDistance - getX(), moveTargets.fluid);
+        runMotion<XPosition, StraightOutput<1>, UntilCrossed>(movePID, moveSettle, moveTargets.targetDistance, 0, stopAtEnd);
+        break;
+    }
+    case MOVE_BACK_TO_X_COORD:
+    {
+        scheduleMoveGains(moveBackXSchedule, moveTargets.targetDistance - getX(), moveTargets.fluid);
+        runMotion<XPosition, StraightOutput<-1>, UntilCrossed>(movePID, moveSettle, moveTargets.targetDistance, 0, stopAtEnd);
         break;
     }
     case MOVE_TO_Y_COORD:
     {
-        if (moveTargets.fluid && movePID.gainsAreAtDefaults())
+        scheduleMoveGains(moveCoordinateSchedule, moveTargets.targetDistance - getY(), moveTargets.fluid);
+        runMotion<YPosition, StraightOutput<1>, UntilCrossed>(movePID, moveSettle, moveTargets.targetDistance, 0, stopAtEnd);
+        break;
+    }
+    case MOVE_BACK_TO_Y_COORD:
+    {
+        scheduleMoveGains(moveCoordinateSchedule, moveTargets.targetDistance - getY(), moveTargets.fluid);
+        runMotion<YPosition, StraightOutput<-1>, UntilCrossed>(movePID, moveSettle, moveTargets.targetDistance, 0, stopAtEnd);
+        break;
+    }
+    case MOVE_TO_POINT:
+    {
+        //Progress is measured along the line from the start to the target
+        double dx = moveTargets.targetX - getX();
+        double dy = moveTargets.targetY - getY();
+        double distance = fmax(sqrt(dx * dx + dy * dy), 0.001);
+        pointDirectionX = dx / distance;
+        pointDirectionY = dy / distance;
+        scheduleMoveGains(moveCoordinateSchedule, distance, moveTargets.fluid);
+
+        if (moveTargets.targetDistance < 0)
         {
-            movePID.setGains(6, 0, 0, 75);
+            runMotion<PointProgress, PointOutput<-1>, UntilCrossed>(movePID, moveSettle, 0, 0, stopAtEnd);
         }
-        else if (movePID.gainsAreAtDefaults())
+        else
         {
-            movePID.setGains(6, 0, 0, 30);
+            runMotion<PointProgress, PointOutput<1>, UntilCrossed>(movePID, moveSettle, 0, 0, stopAtEnd);
         }
+        break;
+    }
+    case MOVE_TO_POSE:
+    {
+        scheduleMoveGains(moveCoordinateSchedule, hypot(moveTargets.targetX - getX(), moveTargets.targetY - getY()), moveTargets.fluid);
+        runMotion<PoseProgress, PoseOutput, UntilPosePassed>(movePID, moveSettle, 0, 0, stopAtEnd);
+        break;
+    }
+    }
 
-        double target = moveTargets.targetDistance;
+    leftSlew.resetLimitsToDefaults();
+    rightSlew.resetLimitsToDefaults();
+}
 
-        if (getY() < target)
-        {
-            while (getY() < target)
-            {
-                double PIDSpeed = (movePID.getOutput(target, getY()));
-                moveHeadingCorrection(moveTargets.targetHeading, correctionMultiplier, PIDSpeed, moveTargets.accelStep, false);
-            }
-        }
-        else if (getY() > target)
-        {
-            while (getY() > target)
-            {
-                double PIDSpeed = (-movePID.getOutput(target, getY()));
-                moveHeadingCorrection(moveTargets.targetHeading, correctionMultiplier, PIDSpeed, moveTargets.accelStep, false);
-            }
-        }
-        if (!moveTargets.fluid)
-        {
-            drivePower(0, 0);
-        }
+//******************************************************************************
+//*************************Trajectory Functions*********************************
+
+/**
+ * @brief follow a time-parameterized trajectory with the RAMSETE controller
+ * 
+ * @param points 
+ * @param length 
+ * @param dt time between points in milliseconds
+ * @return Drive& 
+ */
+Drive &Drive::followTrajectory(const TrajectoryPoint *points, int length, int dt)
+{
+    if (dt <= 0)
+    {
+        printf("Trajectory ignored: dt must be at least 1 ms\n");
+        return *this;
+    }
 
-        //set all modifiers back to defaults
-        leftSideSpeed = 0;
-        rightSideSpeed = 0;
-        correctionMultiplier = 0.2;
-        movePID.resetGainsToDefaults();
-        moveComplete = true;
-        moveStopTask();
+    //Waits for the drive task, so points stays valid for the whole movement
+    nextCommand.type = COMMAND_TRAJECTORY;
+    nextCommand.points = points;
+    nextCommand.length = length;
+    nextCommand.dt = dt;
+    sendCommand(false);
 
-        break;
+    return *this;
+}
+
+/**
+ * @brief follow a trajectory generated by okapi's bundled pathfinder
+ * 
+ * @param segments 
+ * @param length 
+ * @return Drive& 
+ */
+Drive &Drive::followTrajectory(const Segment *segments, int length)
+{
+    if (length <= 0)
+    {
+        return *this;
     }
-    case MOVE_BACK_TO_Y_COORD:
+    int dt = lround(segments[0].dt * 1000);
+    if (dt <= 0)
     {
-        if (moveTargets.fluid && movePID.gainsAreAtDefaults())
-        {
-            movePID.setGains(6, 0, 0, 75);
-        }
-        else if (movePID.gainsAreAtDefaults())
-        {
-            movePID.setGains(6, 0, 0, 30);
-        }
+        printf("Trajectory ignored: dt must be at least 1 ms\n");
+        return *this;
+    }
 
-        double target = moveTargets.targetDistance;
+    nextCommand.type = COMMAND_SEGMENTS;
+    nextCommand.segments = segments;
+    nextCommand.length = length;
+    nextCommand.dt = dt;
+    sendCommand(false);
 
-        if (getY() < target)
-        {
-            while (getY() < target)
-            {
-                double PIDSpeed = (-movePID.getOutput(target, getY()));
-                moveHeadingCorrection(moveTargets.targetHeading, correctionMultiplier, PIDSpeed, moveTargets.accelStep, true);
-            }
-        }
-        else if (getY() > target)
+    return *this;
+}
+
+//Drive task side of followTrajectory()
+void Drive::trajectoryTask(const TrajectoryPoint *points, int length, int dt)
+{
+    startMotion(moveSettle);
+    leftVelocityPID.reset();
+    rightVelocityPID.reset();
+    std::uint32_t startTime = pros::millis();
+    std::uint32_t now = startTime;
+    WheelVelocities previous = {0, 0};
+
+    motionName = "followTrajectory";
+    ResponseMetrics response;
+    int index = 0;
+    while (index < length)
+    {
+        std::uint32_t start = pros::micros();
+        double remaining = hypot(points[length - 1].x - getX(), points[length - 1].y - getY());
+        response.update(remaining);
+        if (controlStep(remaining))
         {
-            while (getY() > target)
-            {
-                double PIDSpeed = (movePID.getOutput(target, getY()));
-                moveHeadingCorrection(moveTargets.targetHeading, correctionMultiplier, PIDSpeed, moveTargets.accelStep, true);
-            }
+            break;
         }
-        if (!moveTargets.fluid)
+
+        WheelVelocities output = ramsete.getOutput(points[index], getX(), getY(), getTheta());
+        driveVelocity(output.left, output.right, (output.left - previous.left) * 1000 / dt, (output.right - previous.right) * 1000 / dt);
+        previous = output;
+
+        recordControlStep(start, now, dt);
+        pros::Task::delay_until(&now, dt);
+        index = (now - startTime) / dt;
+    }
+    drivePower(0, 0);
+    finishMotion(&response);
+}
+
+//Drive task side of followTrajectory() for pathfinder segments
+void Drive::trajectoryTask(const Segment *segments, int length, int dt)
+{
+    startMotion(moveSettle);
+    leftVelocityPID.reset();
+    rightVelocityPID.reset();
+    std::uint32_t startTime = pros::millis();
+    std::uint32_t now = startTime;
+    WheelVelocities previous = {0, 0};
+
+    motionName = "followTrajectory";
+    ResponseMetrics response;
+    int index = 0;
+    while (index < length)
+    {
+        std::uint32_t start = pros::micros();
+        double remaining = hypot(segments[length - 1].x - getX(), segments[length - 1].y - getY());
+        response.update(remaining);
+        if (controlStep(remaining))
         {
-            drivePower(0, 0);
+            break;
         }
 
-        //set all modifiers back to defaults
-        leftSideSpeed = 0;
-        rightSideSpeed = 0;
-        correctionMultiplier = 0.2;
-        movePID.resetGainsToDefaults();
-        moveComplete = true;
-        moveStopTask();
+        TrajectoryPoint reference = trajectoryPointFromSegments(segments, index, length);
+        WheelVelocities output = ramsete.getOutput(reference, getX(), getY(), getTheta());
+        driveVelocity(output.left, output.right, (output.left - previous.left) * 1000 / dt, (output.right - previous.right) * 1000 / dt);
+        previous = output;
 
-        break;
-    }
+        recordControlStep(start, now, dt);
+        pros::Task::delay_until(&now, dt);
+        index = (now - startTime) / dt;
     }
+    drivePower(0, 0);
+    finishMotion(&response);
 }
 
 //******************************************************************************
@@ -756,22 +1990,12 @@ void Drive::moveTask(void *parameter)
  * @brief turn for degrees
  * 
  * @param degrees 
+ * @param async 
  * @return Drive& 
  */
-Drive &Drive::turn(int degrees)
+Drive &Drive::turn(int degrees, bool async)
 {
-    if (!turnComplete)
-    {
-        moveStopTask();
-    }
-    if (turn_task != nullptr)
-    {
-        turn_task = nullptr;
-    }
-    turnTargets = {degrees, 0, 0, 0, TURN};
-    turnComplete = false;
-
-    turnTask(nullptr);
+    startTurn({degrees, 0, 0, 0, TURN}, async);
 
     return *this;
 }
@@ -781,22 +2005,12 @@ Drive &Drive::turn(int degrees)
  * 
  * @param degrees 
  * @param rightSideSpeed 
+ * @param async 
  * @return Drive& 
  */
-Drive &Drive::sweepRight(int degrees, int rightSideSpeed)
+Drive &Drive::sweepRight(int degrees, int rightSideSpeed, bool async)
 {
-    if (!turnComplete)
-    {
-        moveStopTask();
-    }
-    if (turn_task != nullptr)
-    {
-        turn_task = nullptr;
-    }
-    turnTargets = {degrees, 0, rightSideSpeed, 0, SWEEP_RIGHT};
-    turnComplete = false;
-
-    turnTask(nullptr);
+    startTurn({degrees, 0, rightSideSpeed, 0, SWEEP_RIGHT}, async);
 
     return *this;
 }
@@ -807,22 +2021,12 @@ Drive &Drive::sweepRight(int degrees, int rightSideSpeed)
  * @param degrees 
  * @param rightSideSpeed 
  * @param errorThreshhold 
+ * @param async 
  * @return Drive& 
  */
-Drive &Drive::sweepRight(int degrees, int rightSideSpeed, int errorThreshhold)
+Drive &Drive::sweepRight(int degrees, int rightSideSpeed, int errorThreshhold, bool async)
 {
-    if (!turnComplete)
-    {
-        moveStopTask();
-    }
-    if (turn_task != nullptr)
-    {
-        turn_task = nullptr;
-    }
-    turnTargets = {degrees, 0, rightSideSpeed, errorThreshhold, SWEEP_RIGHT_WITH_THRESHHOLD};
-    turnComplete = false;
-
-    turnTask(nullptr);
+    startTurn({degrees, 0, rightSideSpeed, errorThreshhold, SWEEP_RIGHT_WITH_THRESHHOLD}, async);
 
     return *this;
 }
@@ -832,22 +2036,12 @@ Drive &Drive::sweepRight(int degrees, int rightSideSpeed, int errorThreshhold)
  * 
  * @param degrees 
  * @param leftSideSpeed 
+ * @param async 
  * @return Drive& 
  */
-Drive &Drive::sweepLeft(int degrees, int leftSideSpeed)
+Drive &Drive::sweepLeft(int degrees, int leftSideSpeed, bool async)
 {
-    if (!turnComplete)
-    {
-        moveStopTask();
-    }
-    if (turn_task != nullptr)
-    {
-        turn_task = nullptr;
-    }
-    turnTargets = {degrees, leftSideSpeed, 0, 0, SWEEP_LEFT};
-    turnComplete = false;
-
-    turnTask(nullptr);
+    startTurn({degrees, leftSideSpeed, 0, 0, SWEEP_LEFT}, async);
 
     return *this;
 }
@@ -858,22 +2052,12 @@ Drive &Drive::sweepLeft(int degrees, int leftSideSpeed)
  * @param degrees 
  * @param leftSideSpeed 
  * @param errorThreshhold 
+ * @param async 
  * @return Drive& 
  */
-Drive &Drive::sweepLeft(int degrees, int leftSideSpeed, int errorThreshhold)
+Drive &Drive::sweepLeft(int degrees, int leftSideSpeed, int errorThreshhold, bool async)
 {
-    if (!turnComplete)
-    {
-        moveStopTask();
-    }
-    if (turn_task != nullptr)
-    {
-        turn_task = nullptr;
-    }
-    turnTargets = {degrees, leftSideSpeed, 0, errorThreshhold, SWEEP_LEFT_WITH_THRESHHOLD};
-    turnComplete = false;
-
-    turnTask(nullptr);
+    startTurn({degrees, leftSideSpeed, 0, errorThreshhold, SWEEP_LEFT_WITH_THRESHHOLD}, async);
 
     return *this;
 }
@@ -883,22 +2067,12 @@ Drive &Drive::sweepLeft(int degrees, int leftSideSpeed, int errorThreshhold)
  * 
  * @param degrees 
  * @param leftSideSpeed 
+ * @param async 
  * @return Drive& 
  */
-Drive &Drive::sweepRightBack(int degrees, int leftSideSpeed)
+Drive &Drive::sweepRightBack(int degrees, int leftSideSpeed, bool async)
 {
-    if (!turnComplete)
-    {
-        moveStopTask();
-    }
-    if (turn_task != nullptr)
-    {
-        turn_task = nullptr;
-    }
-    turnTargets = {degrees, leftSideSpeed, 0, 0, SWEEP_RIGHT_BACK_WITH_THRESHHOLD};
-    turnComplete = false;
-
-    turnTask(nullptr);
+    startTurn({degrees, leftSideSpeed, 0, 0, SWEEP_RIGHT_BACK}, async);
 
     return *this;
 }
@@ -909,22 +2083,12 @@ Drive &Drive::sweepRightBack(int degrees, int leftSideSpeed)
  * @param degrees 
  * @param leftSideSpeed 
  * @param errorThreshhold 
+ * @param async 
  * @return Drive& 
  */
-Drive &Drive::sweepRightBack(int degrees, int leftSideSpeed, int errorThreshhold)
+Drive &Drive::sweepRightBack(int degrees, int leftSideSpeed, int errorThreshhold, bool async)
 {
-    if (!turnComplete)
-    {
-        moveStopTask();
-    }
-    if (turn_task != nullptr)
-    {
-        turn_task = nullptr;
-    }
-    turnTargets = {degrees, leftSideSpeed, 0, errorThreshhold, SWEEP_RIGHT_BACK_WITH_THRESHHOLD};
-    turnComplete = false;
-
-    turnTask(nullptr);
+    startTurn({degrees, leftSideSpeed, 0, errorThreshhold, SWEEP_RIGHT_BACK_WITH_THRESHHOLD}, async);
 
     return *this;
 }
@@ -934,22 +2098,12 @@ Drive &Drive::sweepRightBack(int degrees, int leftSideSpeed, int errorThreshhold
  * 
  * @param degrees 
  * @param rightSideSpeed 
+ * @param async 
  * @return Drive& 
  */
-Drive &Drive::sweepLeftBack(int degrees, int rightSideSpeed)
+Drive &Drive::sweepLeftBack(int degrees, int rightSideSpeed, bool async)
 {
-    if (!turnComplete)
-    {
-        moveStopTask();
-    }
-    if (turn_task != nullptr)
-    {
-        turn_task = nullptr;
-    }
-    turnTargets = {degrees, 0, rightSideSpeed, 0, SWEEP_LEFT_BACK};
-    turnComplete = false;
-
-    turnTask(nullptr);
+    startTurn({degrees, 0, rightSideSpeed, 0, SWEEP_LEFT_BACK}, async);
 
     return *this;
 }
@@ -960,202 +2114,143 @@ Drive &Drive::sweepLeftBack(int degrees, int rightSideSpeed)
  * @param degrees 
  * @param rightSideSpeed 
  * @param errorThreshhold 
+ * @param async 
  * @return Drive& 
  */
-Drive &Drive::sweepLeftBack(int degrees, int rightSideSpeed, int errorThreshhold)
+Drive &Drive::sweepLeftBack(int degrees, int rightSideSpeed, int errorThreshhold, bool async)
 {
-    if (!turnComplete)
-    {
-        moveStopTask();
-    }
-    if (turn_task != nullptr)
-    {
-        turn_task = nullptr;
-    }
-    turnTargets = {degrees, 0, rightSideSpeed, errorThreshhold, SWEEP_LEFT_BACK_WITH_THRESHHOLD};
-    turnComplete = false;
-
-    turnTask(nullptr);
+    startTurn({degrees, 0, rightSideSpeed, errorThreshhold, SWEEP_LEFT_BACK_WITH_THRESHHOLD}, async);
 
     return *this;
 }
 
 void Drive::turnTask(void *parameter)
 {
-    switch (turnTargets.turnType)
-    {
-    case TURN:
-    {
-        int time = 0;
+    motionName = turnNames[turnTargets.turnType];
 
-        while (time < 50) //50
-        {
-            double PIDSpeed = turnPID.getOutput(turnTargets.degrees, getTheta());
-            drivePower(PIDSpeed, -PIDSpeed);
+    matchSlewToVelocity();
 
-            if (fabs(turnPID.getError()) < 2.5)
-            {
-                time++;
-                wait(2);
-            }
-        }
-        drivePower(0, 0);
-        turnPID.resetGainsToDefaults();
-        turnComplete = true;
-        turnStopTask();
-        break;
-    }
-    case SWEEP_RIGHT:
-    {
-        int time = 0;
-        while (time < 25)
-        {
-            drivePower(turnPID.getOutput(turnTargets.degrees, getTheta()), turnTargets.rightSideSpeed);
+    double degrees = turnTargets.degrees;
+    double threshhold = turnTargets.errorThreshhold;
+    bool useMPC = activeCommand.mpc == -1 ? USE_MPC_TURNS : activeCommand.mpc;
 
-            if (abs(turnPID.getError()) < 2.5)
-            {
-                time++;
-                wait(2);
-            }
-            wait(5);
-        }
-        drivePower(0, 0);
-        turnPID.resetGainsToDefaults();
-        turnComplete = true;
-        turnStopTask();
-        break;
-    }
-    case SWEEP_RIGHT_WITH_THRESHHOLD:
+    //Schedule turnPID's gains for the size of the turn unless withTurnGains() set them
+    if (turnPID.gainsAreAtDefaults())
     {
-        // if (turnPID.gainsAreAtDefaults())
-        // {
-        //     turnPID.setGains(1.75, 0, 0, 80);
-        // }
-
-        while (getTheta() < turnTargets.degrees - turnTargets.errorThreshhold)
-        {
-            drivePower(sweepTurnWithThreshholdPID.getOutput(turnTargets.degrees, getTheta()), turnTargets.rightSideSpeed);
-        }
-        turnPID.resetGainsToDefaults();
-        turnComplete = true;
-        turnStopTask();
-        break;
+        GainSchedule &schedule = turnTargets.turnType == TURN ? turnSchedule : sweepSchedule;
+        schedule.apply(turnPID, degrees - getTheta());
     }
-    case SWEEP_LEFT:
+
+    switch (turnTargets.turnType)
     {
-        int time = 0;
-        while (time < 25)
+    case TURN:
+        if (useMPC)
         {
-            drivePower(turnTargets.leftSideSpeed, -turnPID.getOutput(turnTargets.degrees, getTheta()));
-
-            if (abs(turnPID.getError()) < 2.5)
-            {
-                time++;
-                wait(2);
-            }
-            wait(5);
+            motionName = "turnMPC";
+            runMotion<Heading, PointTurnOutput, UntilSettled>(turnMPC, turnSettle, degrees, 0, true);
         }
-        drivePower(0, 0);
-        turnPID.resetGainsToDefaults();
-        turnComplete = true;
-        turnStopTask();
-        break;
-    }
-    case SWEEP_LEFT_WITH_THRESHHOLD:
-    {
-        // if (turnPID.gainsAreAtDefaults())
-        // {
-        //     turnPID.setGains(1.75, 0, 0, 80);
-        // }
-        while (getTheta() > turnTargets.degrees + turnTargets.errorThreshhold)
+        else
         {
-            drivePower(turnTargets.leftSideSpeed, -sweepTurnWithThreshholdPID.getOutput(turnTargets.degrees, getTheta()));
+            runMotion<Heading, PointTurnOutput, UntilSettled>(turnPID, turnSettle, degrees, 0, true);
         }
-        turnPID.resetGainsToDefaults();
-        turnComplete = true;
-        turnStopTask();
         break;
-    }
+    case SWEEP_RIGHT:
+    case SWEEP_LEFT_BACK:
+        runMotion<Heading, LeftSideOutput, UntilSettled>(turnPID, turnSettle, degrees, 0, true);
+        break;
+    case SWEEP_LEFT:
     case SWEEP_RIGHT_BACK:
-    {
-        int time = 0;
-        while (time < 25)
-        {
-            drivePower(turnTargets.leftSideSpeed, -turnPID.getOutput(turnTargets.degrees, getTheta()));
-
-            if (abs(turnPID.getError()) < 2.5)
-            {
-                time++;
-                wait(2);
-            }
-            wait(5);
-        }
-        drivePower(0, 0);
-        turnPID.resetGainsToDefaults();
-        turnComplete = true;
-        turnStopTask();
+        runMotion<Heading, RightSideOutput, UntilSettled>(turnPID, turnSettle, degrees, 0, true);
+        break;
+    //Threshhold sweeps don't stop so they flow into the next movement
+    case SWEEP_RIGHT_WITH_THRESHHOLD:
+        runMotion<Heading, LeftSideOutput, UntilThreshold<1>>(sweepTurnWithThreshholdPID, turnSettle, degrees, threshhold, false);
+        break;
+    case SWEEP_LEFT_BACK_WITH_THRESHHOLD:
+        runMotion<Heading, LeftSideOutput, UntilThreshold<-1>>(sweepTurnWithThreshholdPID, turnSettle, degrees, threshhold, false);
+        break;
+    case SWEEP_LEFT_WITH_THRESHHOLD:
+        runMotion<Heading, RightSideOutput, UntilThreshold<-1>>(sweepTurnWithThreshholdPID, turnSettle, degrees, threshhold, false);
         break;
-    }
     case SWEEP_RIGHT_BACK_WITH_THRESHHOLD:
-    {
-        // if (turnPID.gainsAreAtDefaults())
-        // {
-        //     turnPID.setGains(1.75, 0, 0, 80);
-        // }
-        while (getTheta() < turnTargets.degrees - turnTargets.errorThreshhold)
-        {
-            drivePower(turnTargets.leftSideSpeed, -sweepTurnWithThreshholdPID.getOutput(turnTargets.degrees, getTheta()));
-        }
-        turnPID.resetGainsToDefaults();
-        turnComplete = true;
-        turnStopTask();
+        runMotion<Heading, RightSideOutput, UntilThreshold<1>>(sweepTurnWithThreshholdPID, turnSettle, degrees, threshhold, false);
         break;
     }
-    case SWEEP_LEFT_BACK:
+}
+
+//******************************************************************************
+//*************************Sweep Functions**************************************
+/**
+ * @brief The most recently started movement, to wait for later
+ * 
+ * EXAMPLE:
+ * drive.move(24, 0, 0, true);
+ * MotionHandle toGoal = drive.getLastMotion();
+ * ...
+ * drive.waitFor(toGoal, 2000);
+ * 
+ * @return MotionHandle 
+ */
+MotionHandle Drive::getLastMotion()
+{
+    return {startedSequence.load()};
+}
+
+//Feedback: has the movement finished (completed, timed out, stalled or cancelled)
+bool Drive::isComplete(MotionHandle motion)
+{
+    return completedSequence >= motion.sequence;
+}
+
+/**
+ * @brief Wait for a movement to finish
+ * 
+ * The calling task sleeps on a task notification until the movement
+ * finishes, so don't use task notifications for anything else in a task
+ * that waits on movements.
+ * 
+ * @param motion 
+ * @param timeout ms to wait, or -1 to wait forever
+ * @return true if the movement finished
+ */
+bool Drive::waitFor(MotionHandle motion, int timeout)
+{
+    return waitForSequence(motion.sequence, timeout);
+}
+
+/**
+ * @brief Wait for several movements to finish
+ * 
+ * @param motions 
+ * @param count 
+ * @param timeout ms to wait for all of them, or -1 to wait forever
+ * @return true if every movement finished
+ */
+bool Drive::waitForAll(const MotionHandle *motions, int count, int timeout)
+{
+    std::uint32_t start = pros::millis();
+    for (int i = 0; i < count; i++)
     {
-        int time = 0;
-        while (time < 25)
+        int remaining = -1;
+        if (timeout >= 0)
         {
-            drivePower(turnPID.getOutput(turnTargets.degrees, getTheta()), turnTargets.rightSideSpeed);
-            if (abs(turnPID.getError()) < 2.5)
-            {
-                time++;
-                wait(2);
-            }
-            wait(5);
+            remaining = std::max(timeout - (int)(pros::millis() - start), 0);
         }
-        drivePower(0, 0);
-        turnPID.resetGainsToDefaults();
-        turnComplete = true;
-        turnStopTask();
-        break;
-    }
-    case SWEEP_LEFT_BACK_WITH_THRESHHOLD:
-    {
-        // if (turnPID.gainsAreAtDefaults())
-        // {
-        //     turnPID.setGains(1.75, 0, 0, 80);
-        // }
-        while (getTheta() > turnTargets.degrees + turnTargets.errorThreshhold)
+        if (!waitForSequence(motions[i].sequence, remaining))
         {
-            drivePower(sweepTurnWithThreshholdPID.getOutput(turnTargets.degrees, getTheta()), turnTargets.rightSideSpeed);
+            return false;
         }
-        turnPID.resetGainsToDefaults();
-        turnComplete = true;
-        turnStopTask();
-        break;
-    }
     }
+    return true;
 }
 
-//******************************************************************************
-//*************************Sweep Functions**************************************
 /**
- * @brief helper method to block code until asynchronous movements are complete
+ * @brief Wait for the most recent movement or turn to finish
  * 
+ * @param timeout ms to wait, or -1 to wait forever
+ * @return true if it finished
  */
-void Drive::waitForComplete()
+bool Drive::waitForComplete(int timeout)
 {
-    while (!moveComplete)
-        wait(1);
+    return waitFor(getLastMotion(), timeout);
 }
\ No newline at end of file
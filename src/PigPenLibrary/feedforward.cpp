@@ -0,0 +1,38 @@
+#include "main.h"
+
+Feedforward::Feedforward(double inKS, double inKV, double inKA)
+{
+    kS = inKS;
+    kV = inKV;
+    kA = inKA;
+}
+
+/**
+ * @brief Calculates the voltage (mV) for a target velocity and acceleration
+ * 
+ * kS is applied in the direction of travel to overcome static friction
+ * 
+ * @param velocity 
+ * @param acceleration 
+ * @return double 
+ */
+double Feedforward::getOutput(double velocity, double acceleration)
+{
+    double sign = 0;
+    if (velocity > 0)
+    {
+        sign = 1;
+    }
+    else if (velocity < 0)
+    {
+        sign = -1;
+    }
+    return kS * sign + kV * velocity + kA * acceleration;
+}
+
+void Feedforward::setGains(double inKS, double inKV, double inKA)
+{
+    kS = inKS;
+    kV = inKV;
+    kA = inKA;
+}
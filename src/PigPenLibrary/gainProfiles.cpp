@@ -0,0 +1,141 @@
+#include "main.h"
+
+//Profiles are loaded from here at startup (see initialize.cpp)
+const char *GAIN_PROFILES_FILE = "/usd/gain_profiles.txt";
+
+GainProfiles gainProfiles;
+
+GainProfiles::GainProfiles()
+{
+    count = 0;
+}
+
+/**
+ * @brief Read profiles from a text file, replacing any loaded before
+ * 
+ * @param path 
+ * @return int the number of profiles loaded (0 if the file can't be read)
+ */
+int GainProfiles::load(const char *path)
+{
+    count = 0;
+    FILE *file = fopen(path, "r");
+    if (file == nullptr)
+    {
+        return 0;
+    }
+
+    char line[128];
+    while (fgets(line, sizeof(line), file) != nullptr)
+    {
+        int id, minSpeed;
+        char name[GAIN_PROFILE_NAME_LENGTH];
+        double kP, kI, kD;
+        if (line[0] == '#' || sscanf(line, "%d %15s %lf %lf %lf %d", &id, name, &kP, &kI, &kD, &minSpeed) != 6)
+        {
+            continue;
+        }
+        if (!set(id, name, kP, kI, kD, minSpeed))
+        {
+            printf("Gain profile table is full, skipped %s\n", name);
+        }
+    }
+    fclose(file);
+
+    printf("Loaded %d gain profiles from %s\n", count, path);
+    return count;
+}
+
+/**
+ * @brief Write every profile to a text file (in the format load() reads)
+ * 
+ * @param path 
+ * @return true if the file was written
+ */
+bool GainProfiles::save(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    fprintf(file, "# id name kP kI kD minSpeed\n");
+    for (int i = 0; i < count; i++)
+    {
+        GainProfile &p = profiles[i];
+        fprintf(file, "%d %s %f %f %f %d\n", p.id, p.name, p.kP, p.kI, p.kD, p.minSpeed);
+    }
+    fclose(file);
+    return true;
+}
+
+/**
+ * @brief Find a profile by id
+ * 
+ * @param id 
+ * @return const GainProfile* nullptr if there is no profile with that id
+ */
+const GainProfile *GainProfiles::get(int id)
+{
+    int index = indexOf(id);
+    return index >= 0 ? &profiles[index] : nullptr;
+}
+
+int GainProfiles::indexOf(int id)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (profiles[i].id == id)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+//Feedback: the id of a profile by name, or -1 if there isn't one
+int GainProfiles::getId(const char *name)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(profiles[i].name, name) == 0)
+        {
+            return profiles[i].id;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Add a profile, or replace the profile with the same id
+ * 
+ * @return false if the table is full
+ */
+bool GainProfiles::set(int id, const char *name, double kP, double kI, double kD, int minSpeed)
+{
+    int index = indexOf(id);
+    if (index < 0)
+    {
+        if (count == MAX_GAIN_PROFILES)
+        {
+            return false;
+        }
+        index = count++;
+    }
+
+    GainProfile *profile = &profiles[index];
+    profile->id = id;
+    strncpy(profile->name, name, GAIN_PROFILE_NAME_LENGTH - 1);
+    profile->name[GAIN_PROFILE_NAME_LENGTH - 1] = '\0';
+    profile->kP = kP;
+    profile->kI = kI;
+    profile->kD = kD;
+    profile->minSpeed = minSpeed;
+    return true;
+}
+
+int GainProfiles::size()
+{
+    return count;
+}
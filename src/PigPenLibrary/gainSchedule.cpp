@@ -0,0 +1,61 @@
+#include "main.h"
+
+GainSchedule::GainSchedule(const GainPoint *inPoints, int inLength, double inErrorBand, double inErrorScale)
+{
+    points = inPoints;
+    length = inLength;
+    errorBand = inErrorBand;
+    errorScale = inErrorScale;
+}
+
+//Replace the table (ex. with a single row of auto-tuned gains)
+void GainSchedule::setTable(const GainPoint *inPoints, int inLength)
+{
+    points = inPoints;
+    length = inLength;
+}
+
+/**
+ * @brief Gains for a movement of this size, linearly interpolated
+ * 
+ * @param magnitude 
+ * @return GainPoint 
+ */
+GainPoint GainSchedule::lookup(double magnitude)
+{
+    magnitude = fabs(magnitude);
+    if (magnitude <= points[0].magnitude)
+    {
+        return points[0];
+    }
+
+    for (int i = 1; i < length; i++)
+    {
+        if (magnitude <= points[i].magnitude)
+        {
+            const GainPoint &a = points[i - 1];
+            const GainPoint &b = points[i];
+            double t = (magnitude - a.magnitude) / (b.magnitude - a.magnitude);
+            return {magnitude,
+                    a.kP + (b.kP - a.kP) * t,
+                    a.kI + (b.kI - a.kI) * t,
+                    a.kD + (b.kD - a.kD) * t,
+                    (int)round(a.minSpeed + (b.minSpeed - a.minSpeed) * t)};
+        }
+    }
+    return points[length - 1];
+}
+
+/**
+ * @brief Set a controller's gains for a movement of this size
+ * 
+ * @param pid 
+ * @param magnitude 
+ * @param minSpeed overrides the table's minSpeed if >= 0 (ex. fluid movements)
+ */
+void GainSchedule::apply(PIDController &pid, double magnitude, int minSpeed)
+{
+    GainPoint gains = lookup(magnitude);
+    pid.setGains(gains.kP, gains.kI, gains.kD, minSpeed >= 0 ? minSpeed : gains.minSpeed);
+    pid.setErrorScaling(errorBand, errorScale);
+}
@@ -0,0 +1,128 @@
+#include "main.h"
+
+//Every movement's metrics are added here (see Drive::finishMotion())
+MetricsTable motionMetrics;
+
+ResponseMetrics::ResponseMetrics()
+{
+    reset();
+}
+
+//Start recording a new command
+void ResponseMetrics::reset()
+{
+    started = false;
+    startTime = 0;
+    lastTime = 0;
+    initialError = 0;
+    riseTime = -1;
+    overshoot = 0;
+    integralAbsoluteError = 0;
+    finalError = 0;
+}
+
+/**
+ * @brief Record one control step
+ * 
+ * @param error 
+ */
+void ResponseMetrics::update(double error)
+{
+    std::uint32_t now = pros::millis();
+    if (!started)
+    {
+        started = true;
+        startTime = now;
+        lastTime = now;
+        initialError = error;
+    }
+
+    integralAbsoluteError += fabs(error) * (now - lastTime) / 1000.0;
+    lastTime = now;
+    finalError = error;
+
+    if (riseTime < 0 && fabs(error) <= 0.1 * fabs(initialError))
+    {
+        riseTime = now - startTime;
+    }
+
+    //Past the target the error has the opposite sign to the initial error
+    if (error * initialError < 0)
+    {
+        overshoot = fmax(overshoot, fabs(error));
+    }
+}
+
+MetricsTable::MetricsTable()
+{
+    clear();
+}
+
+void MetricsTable::add(MetricsRecord record)
+{
+    records[next] = record;
+    next = (next + 1) % MAX_METRICS;
+    if (count < MAX_METRICS)
+    {
+        count++;
+    }
+}
+
+/**
+ * @brief A record by age
+ * 
+ * @param index 0 is the oldest record kept
+ * @return MetricsRecord 
+ */
+MetricsRecord MetricsTable::get(int index)
+{
+    return records[(next - count + index + MAX_METRICS) % MAX_METRICS];
+}
+
+int MetricsTable::size()
+{
+    return count;
+}
+
+void MetricsTable::clear()
+{
+    count = 0;
+    next = 0;
+}
+
+//Print the table to the terminal
+void MetricsTable::print()
+{
+    printf("%-24s %6s %9s %9s %6s %9s %6s %4s\n", "motion", "rise", "overshoot", "IAE", "settle", "error", "time", "exit");
+    for (int i = 0; i < count; i++)
+    {
+        MetricsRecord r = get(i);
+        printf("%-24s %6d %9.2f %9.2f %6d %9.2f %6d %4d\n", r.name, r.riseTime, r.overshoot,
+               r.integralAbsoluteError, r.settleTime, r.finalError, r.duration, r.exitReason);
+    }
+}
+
+/**
+ * @brief Write the table to a CSV file (ex. "/usd/metrics.csv")
+ * 
+ * @param path 
+ * @return true if the file was written
+ */
+bool MetricsTable::save(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    fprintf(file, "motion,riseTime,overshoot,iae,settleTime,finalError,duration,exitReason\n");
+    for (int i = 0; i < count; i++)
+    {
+        MetricsRecord r = get(i);
+        fprintf(file, "%s,%d,%f,%f,%d,%f,%d,%d\n", r.name, r.riseTime, r.overshoot,
+                r.integralAbsoluteError, r.settleTime, r.finalError, r.duration, r.exitReason);
+    }
+    fclose(file);
+    return true;
+}
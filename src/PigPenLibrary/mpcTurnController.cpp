@@ -0,0 +1,111 @@
+#include "main.h"
+
+/**
+ * @brief Construct a new MPC Turn Controller and solve its gains
+ * 
+ * @param inA power to angular acceleration (deg/s^2 per power unit)
+ * @param inB angular velocity damping (1/s)
+ * @param qAngle cost of heading error
+ * @param qVelocity cost of angular velocity
+ * @param r cost of power (larger = gentler, less overshoot)
+ * @param horizon control steps (MOTION_PERIOD ms each) to plan over
+ * @param inMaxCurrentPower largest power allowed above the back-EMF (current limit)
+ */
+MPCTurnController::MPCTurnController(double inA, double inB, double qAngle, double qVelocity, double r, int horizon, double inMaxCurrentPower)
+{
+    a = inA;
+    b = inB;
+    maxCurrentPower = inMaxCurrentPower;
+
+    //Discrete model: x = [heading error, angular velocity], x' = A x + B u
+    double dt = MOTION_PERIOD / 1000.0;
+    double A[2][2] = {{1, dt}, {0, 1 - b * dt}};
+    double B[2] = {0, a * dt};
+
+    //Riccati recursion backward from the end of the horizon: P = Q + A'P(A - BK)
+    double P[2][2] = {{qAngle, 0}, {0, qVelocity}};
+    double K[2] = {0, 0};
+    for (int step = 0; step < horizon; step++)
+    {
+        //K = (r + B'PB)^-1 B'PA
+        double BtP[2] = {B[0] * P[0][0] + B[1] * P[1][0], B[0] * P[0][1] + B[1] * P[1][1]};
+        double scale = r + BtP[0] * B[0] + BtP[1] * B[1];
+        K[0] = (BtP[0] * A[0][0] + BtP[1] * A[1][0]) / scale;
+        K[1] = (BtP[0] * A[0][1] + BtP[1] * A[1][1]) / scale;
+
+        double closed[2][2];
+        for (int i = 0; i < 2; i++)
+        {
+            for (int j = 0; j < 2; j++)
+            {
+                closed[i][j] = A[i][j] - B[i] * K[j];
+            }
+        }
+
+        double next[2][2];
+        for (int i = 0; i < 2; i++)
+        {
+            for (int j = 0; j < 2; j++)
+            {
+                double sum = 0;
+                for (int k = 0; k < 2; k++)
+                {
+                    sum += A[k][i] * (P[k][0] * closed[0][j] + P[k][1] * closed[1][j]);
+                }
+                next[i][j] = sum;
+            }
+        }
+        P[0][0] = qAngle + next[0][0];
+        P[0][1] = next[0][1];
+        P[1][0] = next[1][0];
+        P[1][1] = qVelocity + next[1][1];
+    }
+
+    //The first step of the plan is the only one applied (receding horizon)
+    kAngle = K[0];
+    kVelocity = K[1];
+}
+
+/**
+ * @brief Power for a turn to target from the current heading
+ * 
+ * Uses getAngularVelocity() from odometry for the velocity state.
+ * 
+ * @param target 
+ * @param current 
+ * @return double 
+ */
+double MPCTurnController::getOutput(double target, double current)
+{
+    return getOutput(target - current);
+}
+
+//Power for a heading error (degrees)
+double MPCTurnController::getOutput(double error)
+{
+    double velocity = getAngularVelocity();
+    double power = kAngle * error - kVelocity * velocity;
+
+    //Voltage limit, then current limit around the back-EMF of the current speed
+    double backEMF = velocity * b / a;
+    power = fmax(-127, fmin(127, power));
+    power = fmax(backEMF - maxCurrentPower, fmin(backEMF + maxCurrentPower, power));
+    return power;
+}
+
+//Nothing to clear; the state is measured each step
+void MPCTurnController::reset()
+{
+}
+
+//Feedback
+double MPCTurnController::getAngleGain()
+{
+    return kAngle;
+}
+
+//Feedback
+double MPCTurnController::getVelocityGain()
+{
+    return kVelocity;
+}
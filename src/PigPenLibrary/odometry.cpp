@@ -9,8 +9,27 @@ double thetaInRadians = 0;
 double thetaInDegrees = 0;
 double thetaInDegreesUncorrected = 0;
 
-//odom task definition
-pros::Task *odometryTask = nullptr;
+//Velocities (inches per second and degrees per second)
+double linearVelocity = 0;
+double angularVelocity = 0;
+
+/* Odometry runs as scheduler jobs (see scheduler.hpp): the position update
+   every ODOMETRY_PERIOD ms and the LCD telemetry every TELEMETRY_PERIOD ms */
+const int ODOMETRY_PERIOD = 5;
+const int TELEMETRY_PERIOD = 50;
+int odometryJob = -1;
+int telemetryJob = -1;
+
+//Encoder distances from the previous step
+double prevL = 0;
+double prevR = 0;
+double prevS = 0;
+
+//Velocity is measured over at least 10ms so encoder steps don't read as spikes
+std::uint32_t prevVelocityTime = 0;
+double prevVelocityX = 0;
+double prevVelocityY = 0;
+double prevVelocityTheta = 0;
 
 void odometryStartTask(bool reset)
 {
@@ -18,101 +37,122 @@ void odometryStartTask(bool reset)
     {
         resetOdometry();
     }
-    odometryTask = new pros::Task(calculate_position);
+
+    //Measure from the current encoder values and position
+    prevL = L.get_value() * PI * WHEEL_DIAMETER / TICS_PER_REVOLUTION;
+    prevR = R.get_value() * PI * WHEEL_DIAMETER / TICS_PER_REVOLUTION;
+    prevS = S.get_value() * PI * WHEEL_DIAMETER / TICS_PER_REVOLUTION;
+    prevVelocityTime = pros::millis();
+    prevVelocityX = xglobal;
+    prevVelocityY = yglobal;
+    prevVelocityTheta = thetaInRadians;
+
+    if (odometryJob == -1)
+    {
+        odometryJob = scheduler.addJob("odometry", ODOMETRY_PERIOD, odometryStep);
+        telemetryJob = scheduler.addJob("telemetry", TELEMETRY_PERIOD, odometryTelemetry);
+    }
+    else
+    {
+        scheduler.setEnabled(odometryJob, true);
+        scheduler.setEnabled(telemetryJob, true);
+    }
 }
 
 void odometryStopTask()
 {
-    if (odometryTask != nullptr)
-    {
-        //Remove old odom task
-        odometryTask->remove();
-        delete odometryTask;
-        //set to null
-        odometryTask = nullptr;
-    }
+    scheduler.setEnabled(odometryJob, false);
+    scheduler.setEnabled(telemetryJob, false);
 }
 
-void calculate_position(void *parameter)
+//Position update, run every ODOMETRY_PERIOD ms
+void odometryStep()
 {
-    double prevL = 0;
-    double prevR = 0;
-    double prevS = 0;
+    double leftEncoderInches = L.get_value() * PI * WHEEL_DIAMETER / TICS_PER_REVOLUTION;
+    double rightEncoderInches = R.get_value() * PI * WHEEL_DIAMETER / TICS_PER_REVOLUTION;
+    double backEncoderInches = S.get_value() * PI * WHEEL_DIAMETER / TICS_PER_REVOLUTION;
+
+    double currentL = leftEncoderInches;
+    double currentR = rightEncoderInches;
+    double currentS = backEncoderInches;
+
+    double deltaL = currentL - prevL;
+    double deltaR = currentR - prevR;
+    double deltaS = currentS - prevS;
+
+    prevL = currentL;
+    prevR = currentR;
+    prevS = currentS;
+
+    //Theta Calculation
+    double deltaTheta = (deltaL - deltaR) / (LEFT_OFFSET + RIGHT_OFFSET);
+    thetaInRadians += deltaTheta;
+    thetaInDegrees = thetaInRadians * 180 / PI;
+    thetaInDegreesUncorrected = thetaInDegrees;
+    thetaInDegrees = thetaInDegrees - 360 * floor(thetaInDegrees / 360); //Angle Wrap for Display of theta
+    if (thetaInDegrees < 0)
+    {
+        thetaInDegrees = 360 + thetaInDegrees;
+    }
 
-    pros::lcd::initialize();
+    //X & Y Calculation
+    double chord;
+    double chord2;
 
-    while (1)
+    if (deltaTheta == 0)
     {
+        chord = deltaR;
+        chord2 = deltaS;
+    }
+    else
+    {
+        double r = deltaR / deltaTheta;
+        double sinI = sin(deltaTheta / 2);
+        chord = ((r + RIGHT_OFFSET) * sinI) * 2.0;
+
+        double r2 = deltaS / deltaTheta;
+        chord2 = ((r2 + REAR_OFFSET) * sinI) * 2.0;
+    }
 
-        double leftEncoderInches = L.get_value() * PI * WHEEL_DIAMETER / TICS_PER_REVOLUTION;
-        double rightEncoderInches = R.get_value() * PI * WHEEL_DIAMETER / TICS_PER_REVOLUTION;
-        double backEncoderInches = S.get_value() * PI * WHEEL_DIAMETER / TICS_PER_REVOLUTION;
-
-        double currentL = leftEncoderInches;
-        double currentR = rightEncoderInches;
-        double currentS = backEncoderInches;
-
-        double deltaL = currentL - prevL;
-        double deltaR = currentR - prevR;
-        double deltaS = currentS - prevS;
-
-        prevL = currentL;
-        prevR = currentR;
-        prevS = currentS;
-
-        //Theta Calculation
-        double deltaTheta = (deltaL - deltaR) / (LEFT_OFFSET + RIGHT_OFFSET);
-        thetaInRadians += deltaTheta;
-        thetaInDegrees = thetaInRadians * 180 / PI;
-        thetaInDegreesUncorrected = thetaInDegrees;
-        thetaInDegrees = thetaInDegrees - 360 * floor(thetaInDegrees / 360); //Angle Wrap for Display of theta
-        if (thetaInDegrees < 0)
-        {
-            thetaInDegrees = 360 + thetaInDegrees;
-        }
-
-        //X & Y Calculation
-        double chord;
-        double chord2;
-
-        if (deltaTheta == 0)
-        {
-            chord = deltaR;
-            chord2 = deltaS;
-        }
-        else
-        {
-            double r = deltaR / deltaTheta;
-            double sinI = sin(deltaTheta / 2);
-            chord = ((r + RIGHT_OFFSET) * sinI) * 2.0;
-
-            double r2 = deltaS / deltaTheta;
-            chord2 = ((r2 + REAR_OFFSET) * sinI) * 2.0;
-        }
-
-        double p = (deltaTheta / 2) + thetaInRadians;
-        double cosP = cos(p);
-        double sinP = sin(p);
-
-        xglobal = xglobal + (chord * cosP);
-        yglobal = yglobal - (chord * sinP);
-
-        xglobal = xglobal + (chord2 * -sinP);
-        yglobal = yglobal - (chord2 * cosP);
-
-        wait(1);
-
-        //LCD Feedback
-        pros::lcd::print(1, "Theta: %f", thetaInDegrees);
-        pros::lcd::print(2, "X: %f", xglobal);
-        pros::lcd::print(3, "Y: %f", yglobal);
-
-        pros::lcd::print(4, "Right Encoder: %d", R.get_value());
-        pros::lcd::print(5, "Left Encoder: %d", L.get_value());
-        pros::lcd::print(6, "S Encoder: %d", S.get_value());
+    double p = (deltaTheta / 2) + thetaInRadians;
+    double cosP = cos(p);
+    double sinP = sin(p);
+
+    xglobal = xglobal + (chord * cosP);
+    yglobal = yglobal - (chord * sinP);
+
+    xglobal = xglobal + (chord2 * -sinP);
+    yglobal = yglobal - (chord2 * cosP);
+
+    //Velocity Calculation
+    std::uint32_t now = pros::millis();
+    if (now - prevVelocityTime >= 10)
+    {
+        double dt = (now - prevVelocityTime) / 1000.0;
+        double dx = xglobal - prevVelocityX;
+        double dy = yglobal - prevVelocityY;
+        linearVelocity = sqrt(dx * dx + dy * dy) / dt;
+        angularVelocity = (thetaInRadians - prevVelocityTheta) * 180 / PI / dt;
+
+        prevVelocityTime = now;
+        prevVelocityX = xglobal;
+        prevVelocityY = yglobal;
+        prevVelocityTheta = thetaInRadians;
     }
 }
 
+//LCD Feedback, run every TELEMETRY_PERIOD ms
+void odometryTelemetry()
+{
+    pros::lcd::print(1, "Theta: %f", thetaInDegrees);
+    pros::lcd::print(2, "X: %f", xglobal);
+    pros::lcd::print(3, "Y: %f", yglobal);
+
+    pros::lcd::print(4, "Right Encoder: %d", R.get_value());
+    pros::lcd::print(5, "Left Encoder: %d", L.get_value());
+    pros::lcd::print(6, "S Encoder: %d", S.get_value());
+}
+
 double getTheta()
 {
     return thetaInDegreesUncorrected;
@@ -123,6 +163,18 @@ double getThetaRadians()
     return thetaInRadians;
 }
 
+//Speed in inches per second (always positive)
+double getVelocity()
+{
+    return linearVelocity;
+}
+
+//Turning speed in degrees per second (same direction as getTheta())
+double getAngularVelocity()
+{
+    return angularVelocity;
+}
+
 double getX()
 {
     return xglobal;
@@ -0,0 +1,71 @@
+#include "main.h"
+
+RamseteController::RamseteController(double inB, double inZeta)
+{
+    b = inB;
+    zeta = inZeta;
+}
+
+/**
+ * @brief Calculates wheel velocities that drive the robot onto the reference
+ * 
+ * The math is done in the standard counter-clockwise frame, so headings from
+ * getTheta() (clockwise positive) are negated on the way in and the angular
+ * velocity is converted back when split into the left and right wheels.
+ * 
+ * @param reference 
+ * @param x 
+ * @param y 
+ * @param theta 
+ * @return WheelVelocities 
+ */
+WheelVelocities RamseteController::getOutput(TrajectoryPoint reference, double x, double y, double theta)
+{
+    double heading = -theta * PI / 180;
+    double referenceHeading = -reference.theta * PI / 180;
+    double referenceOmega = -reference.angularVelocity * PI / 180;
+
+    //Error in the robot's local frame
+    double dx = reference.x - x;
+    double dy = reference.y - y;
+    double errorX = cos(heading) * dx + sin(heading) * dy;
+    double errorY = -sin(heading) * dx + cos(heading) * dy;
+    double errorTheta = atan2(sin(referenceHeading - heading), cos(referenceHeading - heading));
+
+    double k = 2 * zeta * sqrt(referenceOmega * referenceOmega + b * reference.velocity * reference.velocity);
+
+    //sin(x)/x, which approaches 1 as the heading error approaches 0
+    double sinc = fabs(errorTheta) < 1e-6 ? 1 : sin(errorTheta) / errorTheta;
+
+    double v = reference.velocity * cos(errorTheta) + k * errorX;
+    double omega = referenceOmega + k * errorTheta + b * reference.velocity * sinc * errorY;
+
+    return {v - omega * DRIVE_TRACK_WIDTH / 2, v + omega * DRIVE_TRACK_WIDTH / 2};
+}
+
+/**
+ * @brief Converts a pathfinder segment into a trajectory point
+ * 
+ * Pathfinder headings are counter-clockwise radians, so they are flipped to
+ * match getTheta(). The angular velocity is taken from the change in heading
+ * to the next segment.
+ * 
+ * @param segments 
+ * @param index 
+ * @param length 
+ * @return TrajectoryPoint 
+ */
+TrajectoryPoint trajectoryPointFromSegments(const Segment *segments, int index, int length)
+{
+    const Segment &segment = segments[index];
+    double angularVelocity = 0;
+
+    if (index + 1 < length && segment.dt > 0)
+    {
+        double delta = segments[index + 1].heading - segment.heading;
+        delta = atan2(sin(delta), cos(delta));
+        angularVelocity = -(delta / segment.dt) * 180 / PI;
+    }
+
+    return {segment.x, segment.y, -segment.heading * 180 / PI, segment.velocity, angularVelocity};
+}
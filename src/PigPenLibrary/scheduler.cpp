@@ -0,0 +1,235 @@
+#include "main.h"
+
+Scheduler scheduler;
+
+Scheduler::Scheduler()
+{
+    count = 0;
+}
+
+/**
+ * @brief Register a periodic job and start its task
+ * 
+ * @param name shown by printStats()
+ * @param period milliseconds between the start of each step
+ * @param step called once per period
+ * @return int the job's id, or -1 if MAX_JOBS jobs are already registered
+ */
+int Scheduler::addJob(const char *name, int period, void (*step)())
+{
+    Job *job = newJob(name, period, step);
+    if (job == nullptr)
+    {
+        return -1;
+    }
+
+    job->task = new pros::Task(runJob, job, job->priority, TASK_STACK_DEPTH_DEFAULT, name);
+    count++;
+
+    assignPriorities();
+    return count - 1;
+}
+
+/**
+ * @brief Register a job whose task paces itself (ex. the drive task)
+ * 
+ * The task is given the job's rate-monotonic priority. It reports each
+ * step with recordRun() instead of being run by the scheduler.
+ * 
+ * @param name shown by printStats()
+ * @param period milliseconds between the start of each step
+ * @param task 
+ * @return int the job's id, or -1 if MAX_JOBS jobs are already registered
+ */
+int Scheduler::addExternalJob(const char *name, int period, pros::Task *task)
+{
+    Job *job = newJob(name, period, nullptr);
+    if (job == nullptr)
+    {
+        return -1;
+    }
+
+    job->task = task;
+    task->set_priority(job->priority);
+    count++;
+
+    assignPriorities();
+    return count - 1;
+}
+
+/**
+ * @brief Replace an external job's task (ex. opcontrol, which is a new task every time it starts)
+ * 
+ * @param id 
+ * @param task the new task, or nullptr while the job has none
+ */
+void Scheduler::setTask(int id, pros::Task *task)
+{
+    if (id < 0 || id >= count)
+    {
+        return;
+    }
+
+    jobs[id].task = task;
+    if (task != nullptr)
+    {
+        task->set_priority(jobs[id].priority);
+    }
+}
+
+//Fill in the next job slot with empty statistics; the caller sets its task
+Job *Scheduler::newJob(const char *name, int period, void (*step)())
+{
+    if (count == MAX_JOBS)
+    {
+        printf("Scheduler is full, %s was not added\n", name);
+        return nullptr;
+    }
+
+    Job &job = jobs[count];
+    job.name = name;
+    job.period = period;
+    job.step = step;
+    job.enabled = true;
+    job.runs = 0;
+    job.deadlineMisses = 0;
+    job.lastExecutionTime = 0;
+    job.worstExecutionTime = 0;
+    job.priority = priorityFor(period);
+    job.task = nullptr;
+    return &job;
+}
+
+/**
+ * @brief Record one step of an external job
+ * 
+ * @param id 
+ * @param executionTime microseconds the step took
+ * @param missed true if the step finished after its next release
+ */
+void Scheduler::recordRun(int id, std::uint32_t executionTime, bool missed)
+{
+    if (id < 0 || id >= count)
+    {
+        return;
+    }
+
+    Job &job = jobs[id];
+    job.runs++;
+    job.lastExecutionTime = executionTime;
+    job.worstExecutionTime = std::max(job.worstExecutionTime, executionTime);
+    if (missed)
+    {
+        job.deadlineMisses++;
+    }
+}
+
+//Task body shared by every job
+void Scheduler::runJob(void *parameter)
+{
+    Job &job = *(Job *)parameter;
+    std::uint32_t release = pros::millis();
+
+    while (true)
+    {
+        if (job.enabled)
+        {
+            std::uint32_t start = pros::micros();
+            job.step();
+            std::uint32_t executionTime = pros::micros() - start;
+
+            job.runs++;
+            job.lastExecutionTime = executionTime;
+            job.worstExecutionTime = std::max(job.worstExecutionTime, executionTime);
+        }
+
+        //Finished after the next release, or started too late to finish in time
+        if ((int)(pros::millis() - release) >= job.period)
+        {
+            job.deadlineMisses++;
+        }
+        pros::Task::delay_until(&release, job.period);
+    }
+}
+
+/**
+ * @brief Pause or resume a job (its task keeps its place and statistics)
+ * 
+ * @param id 
+ * @param enabled 
+ */
+void Scheduler::setEnabled(int id, bool enabled)
+{
+    if (id >= 0 && id < count)
+    {
+        jobs[id].enabled = enabled;
+    }
+}
+
+/**
+ * @brief Rate-monotonic priority for a period
+ * 
+ * The fastest registered rate gets TASK_PRIORITY_DEFAULT + 4, each slower
+ * rate one less, down to TASK_PRIORITY_MIN + 1.
+ * 
+ * @param period 
+ * @return std::uint32_t 
+ */
+std::uint32_t Scheduler::priorityFor(int period)
+{
+    //Count the distinct registered periods faster than this one
+    int rank = 0;
+    for (int i = 0; i < count; i++)
+    {
+        bool counted = false;
+        for (int j = 0; j < i; j++)
+        {
+            counted = counted || jobs[j].period == jobs[i].period;
+        }
+        if (!counted && jobs[i].period < period)
+        {
+            rank++;
+        }
+    }
+    return std::max(TASK_PRIORITY_DEFAULT + 4 - rank, TASK_PRIORITY_MIN + 1);
+}
+
+//Update every job's priority after the set of periods changes
+void Scheduler::assignPriorities()
+{
+    for (int i = 0; i < count; i++)
+    {
+        std::uint32_t priority = priorityFor(jobs[i].period);
+        if (priority != jobs[i].priority)
+        {
+            jobs[i].priority = priority;
+            if (jobs[i].task != nullptr)
+            {
+                jobs[i].task->set_priority(priority);
+            }
+        }
+    }
+}
+
+//Feedback: a copy of a job's settings and statistics
+Job Scheduler::getJob(int id)
+{
+    return jobs[id];
+}
+
+int Scheduler::size()
+{
+    return count;
+}
+
+//Print every job's timing to the terminal
+void Scheduler::printStats()
+{
+    printf("%-16s %6s %8s %8s %8s %10s %10s\n", "job", "period", "priority", "runs", "missed", "last(us)", "worst(us)");
+    for (int i = 0; i < count; i++)
+    {
+        Job &job = jobs[i];
+        printf("%-16s %6d %8d %8d %8d %10d %10d\n", job.name, job.period, (int)job.priority, job.runs,
+               job.deadlineMisses, (int)job.lastExecutionTime, (int)job.worstExecutionTime);
+    }
+}
@@ -0,0 +1,94 @@
+#include "main.h"
+
+SettleDetector::SettleDetector(double inErrorTolerance, double inDerivativeTolerance, int inSettleTime,
+                               double inSmallError, int inSmallErrorTime, double inLargeError, int inLargeErrorTime)
+{
+    errorTolerance = inErrorTolerance;
+    derivativeTolerance = inDerivativeTolerance;
+    settleTime = inSettleTime;
+    smallError = inSmallError;
+    smallErrorTime = inSmallErrorTime;
+    largeError = inLargeError;
+    largeErrorTime = inLargeErrorTime;
+
+    reset();
+}
+
+/**
+ * @brief Call once per control step with the current error
+ * 
+ * @param error 
+ * @return true once any settle window has been held long enough
+ */
+bool SettleDetector::isSettled(double error)
+{
+    std::uint32_t now = pros::millis();
+
+    //Only update the derivative once time has passed so fast loops don't read 0
+    if (firstStep)
+    {
+        prevError = error;
+        firstStep = false;
+    }
+    else if (now > prevTime)
+    {
+        derivative = (error - prevError) * 1000 / (now - prevTime);
+        prevError = error;
+        prevTime = now;
+    }
+
+    //Track when the error entered each window (leaving a window restarts its timer)
+    bool tolerance = fabs(error) < errorTolerance && fabs(derivative) < derivativeTolerance;
+    if (tolerance && !inTolerance)
+    {
+        toleranceEnteredTime = now;
+    }
+    inTolerance = tolerance;
+
+    bool small = fabs(error) < smallError;
+    if (small && !inSmall)
+    {
+        smallEnteredTime = now;
+    }
+    inSmall = small;
+
+    bool large = fabs(error) < largeError;
+    if (large && !inLarge)
+    {
+        largeEnteredTime = now;
+    }
+    inLarge = large;
+
+    bool settled = (inTolerance && (int)(now - toleranceEnteredTime) >= settleTime) ||
+                   (smallErrorTime > 0 && inSmall && (int)(now - smallEnteredTime) >= smallErrorTime) ||
+                   (largeErrorTime > 0 && inLarge && (int)(now - largeEnteredTime) >= largeErrorTime);
+
+    if (settled && timeToSettle < 0)
+    {
+        timeToSettle = now - startTime;
+    }
+    return settled;
+}
+
+//Call at the start of each movement
+void SettleDetector::reset()
+{
+    prevError = 0;
+    derivative = 0;
+    prevTime = pros::millis();
+    startTime = prevTime;
+    toleranceEnteredTime = prevTime;
+    smallEnteredTime = prevTime;
+    largeEnteredTime = prevTime;
+    inTolerance = false;
+    inSmall = false;
+    inLarge = false;
+    firstStep = true;
+    timeToSettle = -1;
+}
+
+//Feedback: milliseconds from reset() until settled (-1 if not settled)
+int SettleDetector::getSettleTime()
+{
+    return timeToSettle;
+}
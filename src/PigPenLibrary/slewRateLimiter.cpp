@@ -0,0 +1,75 @@
+#include "main.h"
+
+SlewRateLimiter::SlewRateLimiter(double inMaxRise, double inMaxFall)
+{
+    maxRise = inMaxRise;
+    maxFall = inMaxFall;
+    output = 0;
+    lastTime = 0;
+
+    //Stores initial values as defaults
+    DEFAULT_MAXRISE = inMaxRise;
+    DEFAULT_MAXFALL = inMaxFall;
+}
+
+/**
+ * @brief Moves the output toward target by no more than the rate allows
+ * 
+ * A limit <= 0 disables that direction's limit. The time step is capped at
+ * 50ms so the first call after a long pause can't jump straight to target.
+ * 
+ * @param target 
+ * @return double 
+ */
+double SlewRateLimiter::step(double target)
+{
+    std::uint32_t now = pros::millis();
+    double dt = fmin(now - lastTime, 50) / 1000.0;
+    lastTime = now;
+
+    double delta = target - output;
+
+    //Speeding up means moving away from zero
+    bool rising = (output >= 0 && delta > 0) || (output <= 0 && delta < 0);
+    double limit = rising ? maxRise : maxFall;
+
+    if (limit > 0)
+    {
+        double maxStep = limit * dt;
+        delta = fmax(-maxStep, fmin(maxStep, delta));
+    }
+    output += delta;
+
+    return output;
+}
+
+//Sets the current output without limiting (ex. to a measured speed)
+void SlewRateLimiter::reset(double value)
+{
+    output = value;
+    lastTime = pros::millis();
+}
+
+void SlewRateLimiter::setLimits(double inMaxRise, double inMaxFall)
+{
+    maxRise = inMaxRise;
+    maxFall = inMaxFall;
+}
+
+void SlewRateLimiter::setMaxRise(double inMaxRise)
+{
+    maxRise = inMaxRise;
+}
+
+//Reset limits to stored defaults (see constructor)
+void SlewRateLimiter::resetLimitsToDefaults()
+{
+    maxRise = DEFAULT_MAXRISE;
+    maxFall = DEFAULT_MAXFALL;
+}
+
+//Feedback
+double SlewRateLimiter::getOutput()
+{
+    return output;
+}
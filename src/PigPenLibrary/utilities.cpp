@@ -8,4 +8,15 @@
 void wait(int time)
 {
     pros::delay(time);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Wraps an angle in degrees to the range [-180, 180)
+ * 
+ * @param degrees 
+ * @return double 
+ */
+double wrapAngle(double degrees)
+{
+    return degrees - 360 * floor((degrees + 180) / 360);
+}
@@ -12,31 +12,33 @@ const char *autoNames[autoCount] = {
     "Blue Autonomous"};
 /***********************************************************/
 
-void autonSelector(void *parameter)
-{
-    wait(500); //Fix Bug that starts index at 2
-    pros::lcd::print(6, "%s", autoNames[autonIndex]);
+//Presses are ignored until this time (ms) so one press only moves one step
+std::uint32_t selectorIgnoreUntil = 0;
 
-    while (true)
+//Auton selector buttons, run every 20ms by the scheduler
+void autonSelectorStep()
+{
+    if (pros::millis() < selectorIgnoreUntil)
     {
+        return;
+    }
 
-        if (forwardSelectorLimit.get_value())
-        {
-            autonIndex = autonIndex + 1;
-            if (autonIndex == autoCount)
-                autonIndex = 0;
+    if (forwardSelectorLimit.get_value())
+    {
+        autonIndex = autonIndex + 1;
+        if (autonIndex == autoCount)
+            autonIndex = 0;
 
-            pros::lcd::print(6, "%s", autoNames[autonIndex]);
-            wait(300);
-        }
-        else if (backwardSelectorLimit.get_value())
-        {
-            autonIndex = autonIndex - 1;
-            if (autonIndex == autoCount)
-                autonIndex = 0;
-            pros::lcd::print(6, "%s", autoNames[autonIndex]);
-            wait(300);
-        }
+        pros::lcd::print(6, "%s", autoNames[autonIndex]);
+        selectorIgnoreUntil = pros::millis() + 300;
+    }
+    else if (backwardSelectorLimit.get_value())
+    {
+        autonIndex = autonIndex - 1;
+        if (autonIndex == autoCount)
+            autonIndex = 0;
+        pros::lcd::print(6, "%s", autoNames[autonIndex]);
+        selectorIgnoreUntil = pros::millis() + 300;
     }
 }
 
@@ -54,12 +56,18 @@ void initialize()
     /* Initialize the Odometry (Position Tracking) Task */
     odometryStartTask();
 
+    /* Start the Drive Task that runs every movement */
+    Drive::driveStartTask();
+
+    /* Load any gains saved by the relay auto tuner and the named gain profiles */
+    RelayAutoTuner::loadSavedGains();
+    gainProfiles.load(GAIN_PROFILES_FILE);
+
     /* Autonomous Selector Initialization */
-    pros::Task lcd_task(autonSelector);
     pros::lcd::set_text(6, "<Select an Autonomous>");
-    lcd_task.set_priority(LV_TASK_PRIO_LOW); //Task infinite loop bug fix
-    if (pros::competition::is_autonomous())
+    if (!pros::competition::is_autonomous())
     {
-        lcd_task.remove();
+        selectorIgnoreUntil = pros::millis() + 500; //Fix Bug that starts index at 2
+        scheduler.addJob("autonSelector", 20, autonSelectorStep);
     }
 }
\ No newline at end of file
@@ -1,11 +1,23 @@
 #include "main.h"
 
+//Driver control loop, timed as the scheduler's "driver" job
+int driverJob = -1;
+pros::Task *driverTask = nullptr;
+
 /**
  * Runs while the robot is in the disabled state of Field Management System or
  * the VEX Competition Switch, following either autonomous or opcontrol. When
  * the robot is enabled, this task will exit.
  */
-void disabled() {}
+void disabled()
+{
+	//Stop any movement autonomous left running; tasks waiting on it were deleted
+	drive.cancel();
+	Drive::releaseWaiters();
+
+	//The opcontrol task has been deleted
+	scheduler.setTask(driverJob, nullptr);
+}
 
 /**
  * Runs after initialize(), and before autonomous when connected to the Field
@@ -33,9 +45,28 @@ void competition_initialize() {}
  */
 void opcontrol()
 {
+	//Driver control owns the drive, so stop any movement autonomous left running
+	Drive::releaseWaiters();
+	Drive::stopMotions();
+
+	//opcontrol runs in a new task every time it starts
+	delete driverTask;
+	driverTask = new pros::Task(pros::c::task_get_current());
+	if (driverJob == -1)
+	{
+		driverJob = scheduler.addExternalJob("driver", MOTION_PERIOD, driverTask);
+	}
+	else
+	{
+		scheduler.setTask(driverJob, driverTask);
+	}
+
+	std::uint32_t release = pros::millis();
 	while (true)
 	{
+		std::uint32_t start = pros::micros();
 		drive.driveOP();
-		wait(5);
+		scheduler.recordRun(driverJob, pros::micros() - start, (int)(pros::millis() - release) >= MOTION_PERIOD);
+		pros::Task::delay_until(&release, MOTION_PERIOD);
 	}
 }
@@ -0,0 +1,383 @@
+/**
+ * @brief Host-side gain optimizer for the chassis PIDControllers
+ * 
+ * Searches kP, kI, kD and minSpeed for moves and turns by simulating
+ * thousands of movements, then prints a ranked table for each movement
+ * size and GainPoint tables ready to paste into the "Chassis Gain
+ * Schedules" block of drive.cpp.
+ * 
+ * This runs on your computer, not the V5 brain. Build and run with:
+ *   g++ -std=c++17 -O3 -march=native -pthread tools/gainOptimizer.cpp -o gainOptimizer
+ *   ./gainOptimizer [candidates per search (default 20000)] [threads (default all cores)]
+ * 
+ * The simulator is a first-order drivetrain model (top speed, time
+ * constant and static friction) behind the same slew limits, PID,
+ * minSpeed and error scaling logic, and exit conditions the robot uses:
+ * moves end once they reach or pass the target (UntilCrossed) and turns
+ * end once settled. After the exit the drive is stopped and the robot
+ * coasts, so overshoot and error are where it comes to rest. Set the Plant values
+ * below from your robot (log getVelocity()/getAngularVelocity() during a
+ * full power move and turn) before trusting the results.
+ * 
+ * Candidates are stored structure-of-arrays and stepped together, so the
+ * per-step controller and plant math vectorizes across candidates. Each
+ * thread simulates its own slice of the candidates.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+//Must match odometry.cpp and robotConfig.cpp (distance moves use encoder ticks)
+const double TICS_PER_REVOLUTION = 360;
+const double WHEEL_DIAMETER = 2.75;
+
+//Control loop period in seconds (MOTION_PERIOD)
+const double DT = 0.005;
+//Movements that haven't finished by this time (seconds) are rejected
+const double MAX_TIME = 4;
+//A stopped robot is at rest below this speed (units per second)
+const double REST_SPEED = 0.01;
+
+/**
+ * @brief Drivetrain model for one kind of movement
+ * 
+ * Units are inches or degrees. Slew limits match leftSlew/rightSlew.
+ */
+struct Plant
+{
+    double topSpeed;     //units per second at full power
+    double timeConstant; //seconds to reach 63% of the commanded speed
+    double staticPower;  //power (0-127) needed to start moving
+    double maxRise;      //slew limits in power per second
+    double maxFall;
+};
+
+//Mirrors the SettleDetector constructor parameters
+struct Settle
+{
+    double errorTolerance;
+    double derivativeTolerance;
+    double settleTime;
+    double smallError;
+    double smallTime;
+    double largeError;
+    double largeTime;
+};
+
+//Ranges searched and limits every accepted candidate must meet
+struct Search
+{
+    const char *name;
+    const char *tableName;
+    Plant plant;
+    Settle settle;
+    std::vector<double> magnitudes;
+    double kPMin, kPMax;
+    double kIMax;
+    double kDMax;
+    int minSpeedMin, minSpeedMax;
+    double maxOvershoot;
+    double maxFinalError;
+    const char *tickTableName; //also print the gains per encoder tick (moves only)
+    const char *scheduleName;  //GainSchedule the table is pasted into
+    double errorBand;          //that schedule's error scaling (see PIDController::setErrorScaling())
+    double errorScale;
+    bool untilCrossed;         //exits on reaching the target (moves) instead of settling (turns)
+};
+
+/**
+ * @brief All candidates for one simulated movement, structure-of-arrays
+ * 
+ */
+struct Batch
+{
+    std::vector<double> kP, kI, kD, minSpeed;
+    std::vector<double> position, velocity, output, integral, derivative, prevPosition;
+    std::vector<double> toleranceTime, smallTime, largeTime;
+    std::vector<double> settleTime, overshoot, finalError;
+
+    explicit Batch(size_t n)
+        : kP(n), kI(n), kD(n), minSpeed(n), position(n), velocity(n), output(n), integral(n),
+          derivative(n), prevPosition(n), toleranceTime(n), smallTime(n), largeTime(n),
+          settleTime(n), overshoot(n), finalError(n)
+    {
+    }
+};
+
+struct Result
+{
+    double kP, kI, kD;
+    int minSpeed;
+    double settleTime, overshoot, finalError; //settleTime is when the movement exits
+    bool feasible;
+};
+
+/**
+ * @brief Simulate candidates [begin, end) moving to target
+ * 
+ * The inner loops only use arithmetic and selects so they vectorize.
+ */
+void simulate(Batch &b, size_t begin, size_t end, double target, const Search &search)
+{
+    const Plant &plant = search.plant;
+    const Settle &settle = search.settle;
+    for (size_t i = begin; i < end; i++)
+    {
+        b.position[i] = b.velocity[i] = b.output[i] = b.integral[i] = b.derivative[i] = b.prevPosition[i] = 0;
+        b.toleranceTime[i] = b.smallTime[i] = b.largeTime[i] = 0;
+        b.settleTime[i] = -1;
+        b.overshoot[i] = 0;
+        b.finalError[i] = fabs(target);
+    }
+
+    double sign = target >= 0 ? 1 : -1;
+    double *kP = b.kP.data(), *kI = b.kI.data(), *kD = b.kD.data(), *minSpeed = b.minSpeed.data();
+    double *position = b.position.data(), *velocity = b.velocity.data(), *output = b.output.data();
+    double *integral = b.integral.data(), *derivative = b.derivative.data(), *prevPosition = b.prevPosition.data();
+    double *toleranceTime = b.toleranceTime.data(), *smallTime = b.smallTime.data(), *largeTime = b.largeTime.data();
+    double *settleTime = b.settleTime.data(), *overshoot = b.overshoot.data(), *finalError = b.finalError.data();
+
+    for (int step = 0; step * DT < MAX_TIME; step++)
+    {
+        double t = step * DT;
+        int running = 0;
+
+        for (size_t i = begin; i < end; i++)
+        {
+            double error = target - position[i];
+            bool active = settleTime[i] < 0;
+
+            //PIDController: derivative on measurement, integral reset on sign change and clamped
+            double rawDerivative = -(position[i] - prevPosition[i]) / DT;
+            derivative[i] = step == 0 ? 0 : 0.5 * rawDerivative + 0.5 * derivative[i];
+            prevPosition[i] = position[i];
+            double newIntegral = error * integral[i] < 0 ? 0 : integral[i] + error * DT;
+            double integralLimit = kI[i] > 0 ? 127 / kI[i] : 0;
+            integral[i] = std::fmax(-integralLimit, std::fmin(integralLimit, newIntegral));
+
+            //kP blends toward errorScale * kP inside errorBand
+            double bandFraction = search.errorBand > 0 ? std::fmin(fabs(error) / search.errorBand, 1) : 1;
+            double scaledKP = kP[i] * (search.errorScale + (1 - search.errorScale) * bandFraction);
+
+            double power = scaledKP * error + kI[i] * integral[i] + kD[i] * derivative[i];
+            double raised = error > 0 ? minSpeed[i] : -minSpeed[i];
+            power = (fabs(error) >= 0.5 && fabs(power) < minSpeed[i]) ? raised : power;
+            power = std::fmax(-127, std::fmin(127, power));
+
+            //SlewRateLimiter: speeding up is limited by maxRise, slowing down by maxFall
+            double delta = power - output[i];
+            double limit = (fabs(power) > fabs(output[i]) ? plant.maxRise : plant.maxFall) * DT;
+            //drivePower(0, 0) after the exit stops the motors immediately
+            output[i] = active ? output[i] + std::fmax(-limit, std::fmin(limit, delta)) : 0;
+
+            //First-order drivetrain with static friction
+            double commanded = output[i] / 127 * plant.topSpeed;
+            bool stuck = fabs(velocity[i]) < REST_SPEED && fabs(output[i]) < plant.staticPower;
+            velocity[i] = stuck ? 0 : velocity[i] + (commanded - velocity[i]) / plant.timeConstant * DT;
+            position[i] += velocity[i] * DT;
+
+            //SettleDetector windows
+            double newError = fabs(target - position[i]);
+            double speed = fabs(velocity[i]);
+            toleranceTime[i] = (newError < settle.errorTolerance && speed < settle.derivativeTolerance) ? toleranceTime[i] + DT : 0;
+            smallTime[i] = newError < settle.smallError ? smallTime[i] + DT : 0;
+            largeTime[i] = newError < settle.largeError ? largeTime[i] + DT : 0;
+            bool settled = toleranceTime[i] * 1000 >= settle.settleTime ||
+                           smallTime[i] * 1000 >= settle.smallTime ||
+                           largeTime[i] * 1000 >= settle.largeTime;
+            //UntilCrossed: reached or passed the target (or settled just short of it)
+            bool crossed = search.untilCrossed && (target - position[i]) * sign <= 0;
+
+            //Overshoot and error keep updating while the stopped robot coasts
+            overshoot[i] = std::fmax(overshoot[i], (position[i] - target) * sign);
+            finalError[i] = newError;
+            settleTime[i] = (active && (settled || crossed)) ? t + DT : settleTime[i];
+            running += settleTime[i] < 0 || fabs(velocity[i]) >= REST_SPEED;
+        }
+
+        if (running == 0)
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Evaluate every candidate on one movement size using all threads
+ * 
+ */
+std::vector<Result> evaluate(Batch &batch, size_t count, double magnitude, const Search &search, int threads)
+{
+    std::vector<std::thread> workers;
+    size_t chunk = (count + threads - 1) / threads;
+    for (int t = 0; t < threads; t++)
+    {
+        size_t begin = t * chunk;
+        size_t end = std::min(count, begin + chunk);
+        if (begin >= end)
+        {
+            break;
+        }
+        workers.emplace_back(simulate, std::ref(batch), begin, end, magnitude, std::cref(search));
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    std::vector<Result> results(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        Result &r = results[i];
+        r.kP = batch.kP[i];
+        r.kI = batch.kI[i];
+        r.kD = batch.kD[i];
+        r.minSpeed = (int)batch.minSpeed[i];
+        r.settleTime = batch.settleTime[i];
+        r.overshoot = batch.overshoot[i];
+        r.finalError = batch.finalError[i];
+        r.feasible = r.settleTime > 0 && r.overshoot <= search.maxOvershoot && r.finalError <= search.maxFinalError;
+    }
+
+    //Feasible candidates first, fastest exit first
+    std::sort(results.begin(), results.end(), [](const Result &a, const Result &b) {
+        if (a.feasible != b.feasible)
+        {
+            return a.feasible;
+        }
+        return a.settleTime < b.settleTime;
+    });
+    return results;
+}
+
+//Random candidates spread over the search ranges (fixed seed so runs repeat)
+void fillCandidates(Batch &batch, size_t count, const Search &search)
+{
+    std::mt19937 rng(6842);
+    std::uniform_real_distribution<double> unit(0, 1);
+    for (size_t i = 0; i < count; i++)
+    {
+        //kP is searched on a log scale; a quarter of candidates are P-only
+        batch.kP[i] = search.kPMin * pow(search.kPMax / search.kPMin, unit(rng));
+        batch.kI[i] = unit(rng) < 0.25 ? 0 : search.kIMax * unit(rng);
+        batch.kD[i] = unit(rng) < 0.25 ? 0 : search.kDMax * unit(rng);
+        batch.minSpeed[i] = search.minSpeedMin + (int)(unit(rng) * (search.minSpeedMax - search.minSpeedMin + 1));
+    }
+}
+
+/**
+ * @brief Print the best gains for each movement size as a drive.cpp GainPoint table
+ * 
+ * Sizes where no candidate met the overshoot and error limits are left out
+ * (the schedule interpolates across them).
+ */
+void printTable(const char *name, const std::vector<double> &magnitudes, const std::vector<Result> &best, double scale, const Search &search)
+{
+    std::vector<size_t> rows;
+    for (size_t i = 0; i < best.size(); i++)
+    {
+        if (best[i].feasible)
+        {
+            rows.push_back(i);
+        }
+    }
+
+    if (rows.empty())
+    {
+        printf("\n//No size met the limits, so %s was not printed\n", name);
+        return;
+    }
+
+    printf("\n//Tuned for GainSchedule %s(%s, %zu, %g, %g), exiting %s\n", search.scheduleName, name, rows.size(),
+           search.errorBand, search.errorScale, search.untilCrossed ? "on reaching the target" : "once settled");
+    printf("const GainPoint %s[] = {\n", name);
+    for (size_t row = 0; row < rows.size(); row++)
+    {
+        const Result &r = best[rows[row]];
+        printf("    {%g, %.4g, %.4g, %.4g, %d}%s\n", magnitudes[rows[row]], r.kP * scale, r.kI * scale, r.kD * scale,
+               r.minSpeed, row + 1 < rows.size() ? "," : "};");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t candidates = argc > 1 ? strtoul(argv[1], nullptr, 10) : 20000;
+    int threads = argc > 2 ? atoi(argv[2]) : (int)std::max(1u, std::thread::hardware_concurrency());
+    const double inchesPerTick = WHEEL_DIAMETER * M_PI / TICS_PER_REVOLUTION;
+
+    /*************************************************************************
+     * @brief Searches
+     * 
+     * Plant: {top speed, time constant (s), static power, slew rise, slew fall}
+     * Settle: the moveSettle/turnSettle parameters from drive.cpp
+     * Schedule: name, error band and error scale from the "Chassis Gain
+     * Schedules" block of drive.cpp, then whether the movement exits on
+     * reaching the target
+     */
+    std::vector<Search> searches = {
+        {"Moves (gains per inch)", "moveCoordinateGains",
+         {60, 0.15, 8, 600, 2000},
+         {0.5, 2, 50, 0.25, 100, 1, 300},
+         {6, 24, 72},
+         1, 20, 2, 1, 5, 40, 1, 0.5, "moveDistanceGains",
+         "moveCoordinateSchedule", 0, 1, true},
+        {"Turns (gains per degree)", "turnGains",
+         {450, 0.12, 10, 600, 2000},
+         {2.5, 10, 50, 1, 100, 4, 500},
+         {5, 45, 90, 180},
+         0.3, 6, 0.5, 0.2, 5, 40, 3, 2.5, nullptr,
+         "turnSchedule", 3, 1.5, false}};
+    /************************************************************************/
+
+    printf("Simulating %zu candidates per movement on %d threads\n", candidates, threads);
+    Batch batch(candidates);
+
+    for (const Search &search : searches)
+    {
+        fillCandidates(batch, candidates, search);
+        printf("\n==== %s ====\n", search.name);
+
+        std::vector<Result> best;
+        std::vector<double> failed;
+        for (double magnitude : search.magnitudes)
+        {
+            std::vector<Result> results = evaluate(batch, candidates, magnitude, search, threads);
+            printf("\n%g:\n  %-4s %10s %10s %10s %8s %10s %10s %10s\n", magnitude, "rank", "kP", "kI", "kD", "minSpeed", "exit(s)", "overshoot", "error");
+            for (int rank = 0; rank < 10 && rank < (int)results.size(); rank++)
+            {
+                const Result &r = results[rank];
+                printf("  %-4d %10.4f %10.4f %10.4f %8d %10.3f %10.3f %10.3f%s\n", rank + 1,
+                       r.kP, r.kI, r.kD, r.minSpeed, r.settleTime, r.overshoot, r.finalError, r.feasible ? "" : "  (fails limits)");
+            }
+            best.push_back(results[0]);
+            if (!results[0].feasible)
+            {
+                failed.push_back(magnitude);
+            }
+        }
+
+        if (!failed.empty())
+        {
+            printf("\nWARNING: no candidate met the overshoot and error limits for");
+            for (double magnitude : failed)
+            {
+                printf(" %g", magnitude);
+            }
+            printf("; those sizes are left out of the tables below (widen the search or the limits)\n");
+        }
+
+        printTable(search.tableName, search.magnitudes, best, 1, search);
+        if (search.tickTableName != nullptr)
+        {
+            Search distanceSearch = search;
+            distanceSearch.scheduleName = "moveDistanceSchedule";
+            printTable(search.tickTableName, search.magnitudes, best, inchesPerTick, distanceSearch);
+        }
+    }
+    return 0;
+}